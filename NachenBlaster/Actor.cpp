@@ -3,7 +3,7 @@
 
 //////////////ACTOR//////////////////
 Actor::Actor(int imageID, double startX, double startY, int dir, double size, int depth, StudentWorld* sw)
-:GraphObject(imageID, startX, startY, dir, size, depth)
+:GraphObject(sw->getGraphObjects(), imageID, startX, startY, dir, size, depth)
 {
     m_alive = true;
     m_world = sw;
@@ -39,24 +39,6 @@ bool Actor::offScreen()     //check whether the Actor is off-screen and if so, s
     return false;
 }
 
-///////////STAR///////////
-Star::Star(double startX, double startY, double size, StudentWorld* sw)
-: Actor(IID_STAR, startX, startY, 0, size, 3, sw)
-{
-}
-
-void Star::doSomething()
-{
-    if(!isAlive())      //check alive
-        return;
-    if(getX() <= 0)     //check off-screen
-    {
-        setDead();
-        return;
-    }
-    moveTo(getX() - 1, getY());     //move the star to the left
-}
-
 //////////////////SPACESHIP///////////
 SpaceShip::SpaceShip(int imageID, double startX, double startY, int dir, double size, int depth, int hpt, StudentWorld* sw)
 : Actor(imageID, startX, startY, dir, size, depth, sw)
@@ -221,7 +203,7 @@ Turnip::Turnip(double startX, double startY, Actor* owner)
 
 void Turnip::collideAndMove()
 {
-    if(getWorld()->targetAtNachenBlaster("PROJECTILE", getX(), getY(), getRadius(), 2))
+    if(getWorld()->targetAtNachenBlaster(COLLIDER_PROJECTILE, getX(), getY(), getRadius(), 2))
     //if the turnip collides with the NachenBlaster, set its state to dead and return
     {
         setDead();
@@ -229,7 +211,7 @@ void Turnip::collideAndMove()
     }
     moveTo(getX() - 6, getY());             //move as required
     setDirection(getDirection() + 20);      //change direction as required
-    if(getWorld()->targetAtNachenBlaster("PROJECTILE", getX(), getY(), getRadius(), 2))
+    if(getWorld()->targetAtNachenBlaster(COLLIDER_PROJECTILE, getX(), getY(), getRadius(), 2))
     //if the turnip collides with the NachenBlaster, set its state to dead and return
     {
         setDead();
@@ -249,14 +231,14 @@ void Torpedoe::collideAndMove()
 {
     if(getDirection() == 180)   //if the torpedoe is fired by an alien
     {
-        if(getWorld()->targetAtNachenBlaster("PROJECTILE", getX(), getY(), getRadius(), 8))
+        if(getWorld()->targetAtNachenBlaster(COLLIDER_PROJECTILE, getX(), getY(), getRadius(), 8))
         //if the torpedoe collides with the NachenBlaster, set its state to dead and return
         {
             setDead();
             return;
         }
         moveTo(getX() - 8, getY());     //move as required
-        if(getWorld()->targetAtNachenBlaster("PROJECTILE", getX(), getY(), getRadius(), 8))
+        if(getWorld()->targetAtNachenBlaster(COLLIDER_PROJECTILE, getX(), getY(), getRadius(), 8))
         //if the torpedoe collides with the NachenBlaster, set its state to dead and return
         {
             setDead();
@@ -291,7 +273,7 @@ bool Goodie::collideWithBlaster()
 {
     if(offScreen())     //check off-screen
         return false;
-    if(getWorld()->targetAtNachenBlaster("GOODIE", getX(), getY(), getRadius(), 0))
+    if(getWorld()->targetAtNachenBlaster(COLLIDER_GOODIE, getX(), getY(), getRadius(), 0))
     //if the goodie collides with the NachenBlaster, increase score by 100, set its state to dead and return true
     {
         getWorld()->increaseScore(100);
@@ -357,6 +339,8 @@ void TorpedoeGoodie::giveReward()   //increase torpedoe point
 Alien::Alien(int imageID, double startX, double startY, int hpts, StudentWorld* sw)
 : SpaceShip(imageID, startX, startY, 0, 1.5, 1, hpts, sw)
 {
+    gridCell = -1;
+    gridSlot = -1;
 }
 
 double Alien::getTravelSpeed() const        //return travel speed
@@ -381,7 +365,7 @@ void Alien::setTravelDirection(int d)       //set travel direction as indicated
 
 bool Alien::checkCollideWithBlaster(int hpt, int pt)
 {
-    if(getWorld()->targetAtNachenBlaster("ALIEN", getX(), getY(), getRadius(), hpt))
+    if(getWorld()->targetAtNachenBlaster(COLLIDER_ALIEN, getX(), getY(), getRadius(), hpt))
     //if the alien collides with the NachenBlaster, set its state to dead, inform the StudentWorld, increase score as indicated and introduce an explosion
     {
         setDead();
@@ -393,6 +377,28 @@ bool Alien::checkCollideWithBlaster(int hpt, int pt)
     return false;
 }
 
+void Alien::moveTo(double x, double y)     //move and inform the StudentWorld so its alien grid stays current
+{
+    SpaceShip::moveTo(x, y);
+    getWorld()->alienMoved(this);
+}
+
+int Alien::getGridCell() const      //return the cell of the alien grid holding the alien
+{
+    return gridCell;
+}
+
+int Alien::getGridSlot() const      //return the alien's index within its grid cell
+{
+    return gridSlot;
+}
+
+void Alien::setGridCell(int c, int slot)    //set the cell of the alien grid holding the alien and its index there
+{
+    gridCell = c;
+    gridSlot = slot;
+}
+
 void Alien::move()      //move as required
 {
     if(getTravelDirection() == 135)
@@ -460,7 +466,7 @@ bool AlienWithFlightPlan::fireSomething()
     if(getWorld()->closeToBlaster(getX(), getY()))
     //if the position satisfies the requirement, there is a chance that the alien will fire a turnip
     {
-        int chance = randInt(1, (20 / getWorld()->getLevel()) + 5);
+        int chance = getWorld()->randInt(1, (20 / getWorld()->getLevel()) + 5);
         if(chance == 1)
         {
             getWorld()->createTurnip(getX() - 14, getY(), this);
@@ -481,7 +487,7 @@ void AlienWithFlightPlan::changePlan()
             setTravelDirection(135);
         else if(getFlightPlanLength() == 0)
         {
-            int r = randInt(1, 3);
+            int r = getWorld()->randInt(1, 3);
             switch(r)
             {
                 case 1: setTravelDirection(180); break;
@@ -489,7 +495,7 @@ void AlienWithFlightPlan::changePlan()
                 case 3: setTravelDirection(225); break;
             }
         }
-        setFlightPlanLength(randInt(1, 32));
+        setFlightPlanLength(getWorld()->randInt(1, 32));
     }
 }
 
@@ -529,7 +535,7 @@ void Smoregon::changePlanAgain()
     if(getWorld()->closeToBlaster(getX(), getY()))
     //if position satisfies requirement, there is a certain chance that Smoregon will change flight plan again
     {
-        int chance = randInt(1, (20 / getWorld()->getLevel()) + 5);
+        int chance = getWorld()->randInt(1, (20 / getWorld()->getLevel()) + 5);
         if(chance == 1)
         {
             setTravelDirection(180);
@@ -565,7 +571,7 @@ bool Snagglegon::fireSomething()
     if(getWorld()->closeToBlaster(getX(), getY()))
     //if the position satisfies the requirement, there is a chance that the Snagglegon will fire a torpedoe
     {
-        int chance = randInt(1, (15 / getWorld()->getLevel()) + 10);
+        int chance = getWorld()->randInt(1, (15 / getWorld()->getLevel()) + 10);
         if(chance == 1)
         {
             getWorld()->createTorpedoe(getX() - 14, getY(), this);
@@ -580,7 +586,7 @@ bool Snagglegon::collideWithNachenBlaster()
     if(checkCollideWithBlaster(15, 1000))
     //if collision happens, decrease health by 15 and increase score by 1000, there is 1/6 chance that it will drop an extra life goodie
     {
-        int r = randInt(1, 6);
+        int r = getWorld()->randInt(1, 6);
         if(r == 1)
             getWorld()->createExtraLifeGoodie(getX(), getY());
         return true;
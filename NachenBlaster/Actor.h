@@ -2,6 +2,7 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "ActorPool.h"
 
 //////////////ACTOR///////////////
 class StudentWorld;
@@ -22,14 +23,6 @@ private:
     StudentWorld* m_world;
 };
 
-//////////////STAR/////////////////
-class Star : public Actor
-{
-public:
-    Star(double startX, double startY, double size, StudentWorld* sw);
-    virtual void doSomething();
-};
-
 /////////////////SPACESHIP///////////
 class SpaceShip: public Actor
 {
@@ -67,6 +60,10 @@ public:
     virtual bool isSmoregon() const;    //return true if the alien is a Smoregon
     virtual bool isSnagglegon() const;  //return true if the alien is a Snagglegon
     virtual int returnScore() const = 0;//return score
+    virtual void moveTo(double x, double y);    //move and keep the StudentWorld's alien grid up to date
+    int getGridCell() const;            //return the cell of the alien grid holding the alien
+    int getGridSlot() const;            //return the alien's index within that cell
+    void setGridCell(int c, int slot);  //set the cell of the alien grid holding the alien and its index there
     virtual ~Alien() {};
 protected:
     double getTravelSpeed() const;      //get travel speed
@@ -81,6 +78,8 @@ protected:
 private:
     double travelSpeed;
     int travelDirection;
+    int gridCell;
+    int gridSlot;
 };
 
 ////////////ALIENWITHFLIGHTPLAN/////////////////////
@@ -102,14 +101,14 @@ private:
 };
 
 ///////////SMALLGON/////////////
-class Smallgon : public AlienWithFlightPlan
+class Smallgon : public AlienWithFlightPlan, public PooledActor<Smallgon>
 {
 public:
     Smallgon(double startX, double startY, StudentWorld* sw);
 };
 
 ///////////SMOREGON/////////////
-class Smoregon : public AlienWithFlightPlan
+class Smoregon : public AlienWithFlightPlan, public PooledActor<Smoregon>
 {
 public:
     Smoregon(double startX, double startY, StudentWorld* sw);
@@ -120,7 +119,7 @@ private:
 };
 
 ////////////SNAGGLEGON//////////
-class Snagglegon : public Alien
+class Snagglegon : public Alien, public PooledActor<Snagglegon>
 {
 public:
     Snagglegon(double startX, double startY, StudentWorld* sw);
@@ -145,7 +144,7 @@ private:
 };
 
 /////////CABBAGE////////////
-class Cabbage : public Projectile
+class Cabbage : public Projectile, public PooledActor<Cabbage>
 {
 public:
     Cabbage(double startX, double startY, Actor* owner);
@@ -154,7 +153,7 @@ private:
 };
 
 ////////////TURNIP///////////
-class Turnip : public Projectile
+class Turnip : public Projectile, public PooledActor<Turnip>
 {
 public:
     Turnip(double startX, double startY, Actor* owner);
@@ -163,7 +162,7 @@ private:
 };
 
 ///////////TORPEDOE///////////////
-class Torpedoe : public Projectile
+class Torpedoe : public Projectile, public PooledActor<Torpedoe>
 {
 public:
     Torpedoe(double startX, double startY, Actor* owner);
@@ -183,7 +182,7 @@ protected:
 };
 
 ////////////REPAIRLIFEGOODIE///////////
-class RepairLifeGoodie : public Goodie
+class RepairLifeGoodie : public Goodie, public PooledActor<RepairLifeGoodie>
 {
 public:
     RepairLifeGoodie(double startX, double startY, StudentWorld* sw);
@@ -192,7 +191,7 @@ private:
 };
 
 ///////////EXTRALIFEGOODIE//////////
-class ExtraLifeGoodie : public Goodie
+class ExtraLifeGoodie : public Goodie, public PooledActor<ExtraLifeGoodie>
 {
 public:
     ExtraLifeGoodie(double startX, double startY, StudentWorld* sw);
@@ -201,7 +200,7 @@ private:
 };
 
 ///////////TORPEDOEGOODIE///////////
-class TorpedoeGoodie : public Goodie
+class TorpedoeGoodie : public Goodie, public PooledActor<TorpedoeGoodie>
 {
 public:
     TorpedoeGoodie(double startX, double startY, StudentWorld* sw);
@@ -210,7 +209,7 @@ private:
 };
 
 ///////////EXPLOSION//////////
-class Explosion : public Actor
+class Explosion : public Actor, public PooledActor<Explosion>
 {
 public:
     Explosion(double startX, double startY, StudentWorld* sw);
@@ -0,0 +1,195 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//////////////POOLSTATS///////////////
+struct PoolStats
+{
+    unsigned long allocations;      //objects handed out by the pool
+    unsigned long deallocations;    //objects given back to the pool
+    unsigned long chunks;           //heap allocations the pool itself made
+    unsigned long live;             //objects currently in use
+};
+
+//////////////ACTORPOOLBASE///////////////
+//lets the pools of every type be kept and measured together without knowing their types
+class ActorPoolBase
+{
+public:
+    virtual PoolStats getStats() const = 0;
+    virtual ~ActorPoolBase() {}
+protected:
+    static std::size_t nextTypeIndex()  //return a number not yet given to any pooled type
+    {
+        static std::atomic<std::size_t> next(0);
+        return next++;
+    }
+};
+
+//////////////ACTORPOOL///////////////
+//a free list of T-sized blocks carved out of chunks that are never given
+//back until the pool is destroyed, so once the pool has grown to the busiest
+//moment of the game, creating and destroying a T costs no heap allocation;
+//each block remembers its pool, so a T is given back to the pool it came from
+template<typename T>
+class ActorPool : public ActorPoolBase
+{
+public:
+    ActorPool()
+    : m_free(nullptr)
+    {
+        m_stats.allocations = m_stats.deallocations = m_stats.chunks = m_stats.live = 0;
+    }
+
+    ~ActorPool()
+    {
+        for(size_t i = 0; i < m_chunks.size(); i++)
+            delete [] m_chunks[i];
+    }
+
+    static std::size_t getTypeIndex()   //return the slot of ActorPools that holds the pool for T
+    {
+        static const std::size_t index = nextTypeIndex();
+        return index;
+    }
+
+    void* allocate(std::size_t n)
+    {
+        if(n != sizeof(T))              //a class derived from T is not pooled
+            return ::operator new(n);
+        if(m_free == nullptr)
+            grow();
+        Block* b = m_free;
+        m_free = b->next;
+        b->owner = this;
+        m_stats.allocations++;
+        m_stats.live++;
+        return b->storage;
+    }
+
+    static void deallocate(void* p, std::size_t n)  //give p back to the pool it came from
+    {
+        if(p == nullptr)
+            return;
+        if(n != sizeof(T))
+        {
+            ::operator delete(p);
+            return;
+        }
+        Block* b = reinterpret_cast<Block*>(static_cast<unsigned char*>(p) - offsetof(Block, storage));
+        ActorPool* pool = b->owner;
+        b->next = pool->m_free;
+        pool->m_free = b;
+        pool->m_stats.deallocations++;
+        pool->m_stats.live--;
+    }
+
+    virtual PoolStats getStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    struct Block
+    {
+        union
+        {
+            ActorPool* owner;           //while in use
+            Block* next;                //while free
+        };
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    static const int BLOCKS_PER_CHUNK = 64;
+
+    Block* m_free;
+    std::vector<Block*> m_chunks;
+    PoolStats m_stats;
+
+    void grow()         //add a chunk of blocks to the free list
+    {
+        Block* chunk = new Block[BLOCKS_PER_CHUNK];
+        m_chunks.push_back(chunk);
+        m_stats.chunks++;
+        for(int i = BLOCKS_PER_CHUNK - 1; i >= 0; i--)
+        {
+            chunk[i].next = m_free;
+            m_free = &chunk[i];
+        }
+    }
+
+    ActorPool(const ActorPool&) = delete;
+    ActorPool& operator=(const ActorPool&) = delete;
+};
+
+//////////////ACTORPOOLS///////////////
+//one ActorPool for each pooled type, made the first time a T is created;
+//each world owns one (see GameWorld::getActorPools), so worlds never share a
+//free list and any number of them can run at once, on one thread or many
+class ActorPools
+{
+public:
+    ActorPools() {}
+    ~ActorPools()
+    {
+        for(size_t i = 0; i < m_pools.size(); i++)
+            delete m_pools[i];
+    }
+
+    template<typename T> ActorPool<T>& get()    //return the pool for T
+    {
+        std::size_t index = ActorPool<T>::getTypeIndex();
+        if(index >= m_pools.size())
+            m_pools.resize(index + 1, nullptr);
+        if(m_pools[index] == nullptr)
+            m_pools[index] = new ActorPool<T>;
+        return *static_cast<ActorPool<T>*>(m_pools[index]);
+    }
+
+    PoolStats getTotalStats() const     //return the statistics summed over all the pools
+    {
+        PoolStats total = { 0, 0, 0, 0 };
+        for(size_t i = 0; i < m_pools.size(); i++)
+        {
+            if(m_pools[i] == nullptr)
+                continue;
+            PoolStats s = m_pools[i]->getStats();
+            total.allocations += s.allocations;
+            total.deallocations += s.deallocations;
+            total.chunks += s.chunks;
+            total.live += s.live;
+        }
+        return total;
+    }
+private:
+    std::vector<ActorPoolBase*> m_pools;    //indexed by ActorPool<T>::getTypeIndex()
+
+    ActorPools(const ActorPools&) = delete;
+    ActorPools& operator=(const ActorPools&) = delete;
+};
+
+//////////////POOLEDACTOR///////////////
+//deriving class T from PooledActor<T> makes a T be created from a world's
+//pools, with new (pools) T(...), and deleted back into them with delete
+template<typename T>
+class PooledActor
+{
+public:
+    static void* operator new(std::size_t n, ActorPools& pools)
+    {
+        return pools.get<T>().allocate(n);
+    }
+    static void operator delete(void* p, ActorPools&)  //only if T's constructor throws
+    {
+        ActorPool<T>::deallocate(p, sizeof(T));
+    }
+    static void operator delete(void* p, std::size_t n)
+    {
+        ActorPool<T>::deallocate(p, n);
+    }
+};
+
+#endif // ACTORPOOL_H_
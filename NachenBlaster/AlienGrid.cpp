@@ -0,0 +1,148 @@
+#include "AlienGrid.h"
+#include "Actor.h"
+#include "Collision.h"
+using namespace std;
+
+AlienGrid::AlienGrid()
+{
+    m_nextOrder = 0;
+    m_maxRadius = 0;
+}
+
+void AlienGrid::insert(Alien* a)
+{
+    addToCell(a, m_nextOrder++, cellOf(a));
+    if(a->getRadius() > m_maxRadius)
+        m_maxRadius = a->getRadius();
+}
+
+void AlienGrid::update(Alien* a)
+{
+    int oldCell = a->getGridCell();
+    if(oldCell < 0)                 //not in the grid
+        return;
+    int newCell = cellOf(a);
+    if(newCell == oldCell)          //still in the same cell, only the position changes
+    {
+        Cell& cell = m_cells[oldCell];
+        cell.xs[a->getGridSlot()] = a->getX();
+        cell.ys[a->getGridSlot()] = a->getY();
+        return;
+    }
+    unsigned long order = removeFromCell(a);
+    addToCell(a, order, newCell);
+}
+
+void AlienGrid::remove(Alien* a)
+{
+    if(a->getGridCell() < 0)
+        return;
+    removeFromCell(a);
+    a->setGridCell(-1, -1);
+}
+
+void AlienGrid::clear()
+{
+    for(int i = 0; i < COLS * ROWS; i++)
+    {
+        Cell& cell = m_cells[i];
+        cell.aliens.clear();
+        cell.orders.clear();
+        cell.xs.clear();
+        cell.ys.clear();
+        cell.rs.clear();
+    }
+    m_nextOrder = 0;
+    m_maxRadius = 0;
+}
+
+double AlienGrid::maxRadius() const
+{
+    return m_maxRadius;
+}
+
+Alien* AlienGrid::firstHit(double x, double y, double r) const
+{
+    double reach = collisionReach(r, m_maxRadius);
+    int c1 = column(x - reach), c2 = column(x + reach);
+    int r1 = row(y - reach), r2 = row(y + reach);
+    Alien* hit = nullptr;
+    unsigned long hitOrder = 0;
+    for(int row = r1; row <= r2; row++)
+        for(int col = c1; col <= c2; col++)
+        {
+            const Cell& cell = m_cells[row * COLS + col];
+            int n = static_cast<int>(cell.aliens.size());
+            int i = 0;
+            while(i < n)            //keep the earliest inserted alien hit, the one a linear scan would find
+            {
+                int k = firstOverlap(x, y, r, &cell.xs[i], &cell.ys[i], &cell.rs[i], n - i);
+                if(k < 0)
+                    break;
+                i += k;
+                if(hit == nullptr || cell.orders[i] < hitOrder)
+                {
+                    hit = cell.aliens[i];
+                    hitOrder = cell.orders[i];
+                }
+                i++;
+            }
+        }
+    return hit;
+}
+
+/////////////////////////////////
+int AlienGrid::column(double x)     //positions off the playfield fall into the border cells
+{
+    int c = static_cast<int>(x) / CELL_SIZE;
+    if(x < 0 || c < 0)
+        return 0;
+    return c >= COLS ? COLS - 1 : c;
+}
+
+int AlienGrid::row(double y)
+{
+    int r = static_cast<int>(y) / CELL_SIZE;
+    if(y < 0 || r < 0)
+        return 0;
+    return r >= ROWS ? ROWS - 1 : r;
+}
+
+int AlienGrid::cellOf(const Alien* a) const
+{
+    return row(a->getY()) * COLS + column(a->getX());
+}
+
+void AlienGrid::addToCell(Alien* a, unsigned long order, int cell)
+{
+    Cell& c = m_cells[cell];
+    a->setGridCell(cell, static_cast<int>(c.aliens.size()));
+    c.aliens.push_back(a);
+    c.orders.push_back(order);
+    c.xs.push_back(a->getX());
+    c.ys.push_back(a->getY());
+    c.rs.push_back(a->getRadius());
+}
+
+unsigned long AlienGrid::removeFromCell(Alien* a)  //move the last alien of the cell into the vacated slot
+{
+    Cell& c = m_cells[a->getGridCell()];
+    size_t slot = a->getGridSlot();
+    size_t last = c.aliens.size() - 1;
+    unsigned long order = c.orders[slot];
+    if(slot != last)
+    {
+        c.aliens[slot] = c.aliens[last];
+        c.orders[slot] = c.orders[last];
+        c.xs[slot] = c.xs[last];
+        c.ys[slot] = c.ys[last];
+        c.rs[slot] = c.rs[last];
+        c.aliens[slot]->setGridCell(a->getGridCell(), static_cast<int>(slot));
+    }
+    c.aliens.pop_back();
+    c.orders.pop_back();
+    c.xs.pop_back();
+    c.ys.pop_back();
+    c.rs.pop_back();
+    return order;
+}
@@ -0,0 +1,45 @@
+#ifndef ALIENGRID_H_
+#define ALIENGRID_H_
+
+#include "GameConstants.h"
+#include <vector>
+
+class Alien;
+
+//////////////ALIENGRID///////////////
+//uniform bucket grid over the playfield holding only aliens, so a hit test
+//only has to look at the aliens in the cells around the projectile
+class AlienGrid
+{
+public:
+    AlienGrid();
+    void insert(Alien* a);              //add an alien at its current position
+    void update(Alien* a);              //move an alien to the cell of its current position
+    void remove(Alien* a);              //remove an alien from the grid
+    void clear();                       //remove all aliens
+    double maxRadius() const;           //return the largest radius of any alien inserted
+    Alien* firstHit(double x, double y, double r) const;
+    //return the earliest inserted alien that collides with the circle, or nullptr if none does
+private:
+    static const int CELL_SIZE = 32;
+    static const int COLS = (VIEW_WIDTH + CELL_SIZE - 1) / CELL_SIZE;
+    static const int ROWS = (VIEW_HEIGHT + CELL_SIZE - 1) / CELL_SIZE;
+    struct Cell                     //the aliens' circles are kept as separate arrays so they can be tested in batches
+    {
+        std::vector<Alien*> aliens;
+        std::vector<unsigned long> orders;
+        std::vector<double> xs;
+        std::vector<double> ys;
+        std::vector<double> rs;
+    };
+    static int column(double x);
+    static int row(double y);
+    int cellOf(const Alien* a) const;
+    void addToCell(Alien* a, unsigned long order, int cell);
+    unsigned long removeFromCell(Alien* a);     //return the alien's insertion order
+    Cell m_cells[COLS * ROWS];
+    unsigned long m_nextOrder;
+    double m_maxRadius;
+};
+
+#endif // ALIENGRID_H_
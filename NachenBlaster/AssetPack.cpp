@@ -0,0 +1,203 @@
+#include "AssetPack.h"
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define NB_ASSETPACK_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+static_assert(sizeof(AssetPack::Header) == 24, "pack header layout");
+static_assert(sizeof(AssetPack::SourceStamp) == 16, "pack source layout");
+static_assert(sizeof(AtlasSprite) == 24, "pack sprite layout");
+static_assert(sizeof(AssetPack::PackLevel) == 16, "pack level layout");
+
+static const char PACK_MAGIC[4] = { 'N', 'B', 'A', 'P' };
+static const size_t PIXEL_ALIGNMENT = 16;
+
+static size_t alignUp(size_t n, size_t alignment)
+{
+	return (n + alignment - 1) / alignment * alignment;
+}
+
+AssetPack::AssetPack()
+ : m_data(nullptr), m_size(0), m_mapped(false), m_sources(nullptr), m_numSources(0)
+{
+}
+
+AssetPack::~AssetPack()
+{
+	close();
+}
+
+bool AssetPack::open(string filename)
+{
+	close();
+#ifdef NB_ASSETPACK_MMAP
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat info;
+	if (fstat(fd, &info) == 0  &&  info.st_size > 0)
+	{
+		void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED)
+		{
+			m_data = static_cast<const unsigned char*>(p);
+			m_size = static_cast<size_t>(info.st_size);
+			m_mapped = true;
+		}
+	}
+	::close(fd);	// the mapping stays
+	if (!m_mapped)
+		return false;
+#else
+	ifstream packFile(filename, ios::in|ios::binary);
+	if (!packFile)
+		return false;
+	packFile.seekg(0, ios::end);
+	streamoff fileSize = packFile.tellg();
+	if (fileSize <= 0)
+		return false;
+	m_buffer.resize((static_cast<size_t>(fileSize) + 7) / 8);
+	packFile.seekg(0);
+	if (!packFile.read(reinterpret_cast<char*>(m_buffer.data()), fileSize))
+	{
+		m_buffer.clear();
+		return false;
+	}
+	m_data = reinterpret_cast<const unsigned char*>(m_buffer.data());
+	m_size = static_cast<size_t>(fileSize);
+#endif
+	if (!parse())
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void AssetPack::close()
+{
+#ifdef NB_ASSETPACK_MMAP
+	if (m_mapped)
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+	m_mapped = false;
+	m_buffer.clear();
+	m_data = nullptr;
+	m_size = 0;
+	m_view = AtlasView();
+	m_sources = nullptr;
+	m_numSources = 0;
+}
+
+bool AssetPack::stampFile(string filename, SourceStamp& stamp)
+{
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0)
+		return false;
+	stamp.size = static_cast<uint64_t>(info.st_size);
+	stamp.modified = static_cast<int64_t>(info.st_mtime);
+	return true;
+}
+
+bool AssetPack::matchesSources(const vector<SourceStamp>& sources) const
+{
+	if (sources.size() != m_numSources)
+		return false;
+	for (size_t k = 0; k < m_numSources; k++)
+	{
+		if (sources[k].size != m_sources[k].size  ||  sources[k].modified != m_sources[k].modified)
+			return false;
+	}
+	return true;
+}
+
+  // Point m_view into the file, checking that everything it refers to is
+  // within the file
+
+bool AssetPack::parse()
+{
+	if (m_size < sizeof(Header))
+		return false;
+	const Header* header = reinterpret_cast<const Header*>(m_data);
+	if (memcmp(header->magic, PACK_MAGIC, 4) != 0  ||  header->version != VERSION)
+		return false;
+
+	size_t sourcesAt = sizeof(Header);
+	size_t spritesAt = sourcesAt + static_cast<size_t>(header->numSources) * sizeof(SourceStamp);
+	size_t levelsAt = spritesAt + static_cast<size_t>(header->numSprites) * sizeof(AtlasSprite);
+	size_t pixelsAt = levelsAt + static_cast<size_t>(header->numLevels) * sizeof(PackLevel);
+	if (header->numLevels == 0  ||  pixelsAt > m_size)
+		return false;
+
+	m_sources = reinterpret_cast<const SourceStamp*>(m_data + sourcesAt);
+	m_numSources = header->numSources;
+	m_view.sprites = reinterpret_cast<const AtlasSprite*>(m_data + spritesAt);
+	m_view.numSprites = header->numSprites;
+	const PackLevel* levels = reinterpret_cast<const PackLevel*>(m_data + levelsAt);
+	for (uint32_t k = 0; k < header->numLevels; k++)
+	{
+		const PackLevel& level = levels[k];
+		uint64_t bytes = static_cast<uint64_t>(level.width) * level.height * 4;
+		if (level.offset < pixelsAt  ||  level.offset > m_size  ||  bytes > m_size - level.offset)
+			return false;
+		AtlasLevel l = { level.width, level.height, m_data + level.offset };
+		m_view.levels.push_back(l);
+	}
+
+	const AtlasLevel& full = m_view.levels[0];
+	for (size_t k = 0; k < m_view.numSprites; k++)
+	{
+		const AtlasSprite& s = m_view.sprites[k];
+		if (s.x > full.width  ||  s.width > full.width - s.x  ||
+			s.y > full.height  ||  s.height > full.height - s.y)
+			return false;
+	}
+	return true;
+}
+
+bool AssetPack::write(string filename, const SpriteAtlas& atlas, const vector<SourceStamp>& sources)
+{
+	const vector<AtlasSprite>& sprites = atlas.getSprites();
+	const vector<RgbaImage>& levels = atlas.getLevels();
+
+	Header header;
+	memcpy(header.magic, PACK_MAGIC, 4);
+	header.version = VERSION;
+	header.numSprites = static_cast<uint32_t>(sprites.size());
+	header.numLevels = static_cast<uint32_t>(levels.size());
+	header.numSources = static_cast<uint32_t>(sources.size());
+	header.reserved = 0;
+
+	vector<PackLevel> table;
+	size_t offset = sizeof(Header) + sources.size() * sizeof(SourceStamp) + sprites.size() * sizeof(AtlasSprite)
+					+ levels.size() * sizeof(PackLevel);
+	for (const RgbaImage& level : levels)
+	{
+		offset = alignUp(offset, PIXEL_ALIGNMENT);
+		PackLevel l = { level.width, level.height, offset };
+		table.push_back(l);
+		offset += level.pixels.size();
+	}
+
+	ofstream packFile(filename, ios::out|ios::binary);
+	if (!packFile)
+		return false;
+	packFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	packFile.write(reinterpret_cast<const char*>(sources.data()), sources.size() * sizeof(SourceStamp));
+	packFile.write(reinterpret_cast<const char*>(sprites.data()), sprites.size() * sizeof(AtlasSprite));
+	packFile.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(PackLevel));
+	static const char padding[PIXEL_ALIGNMENT] = { 0 };
+	for (size_t k = 0; k < levels.size(); k++)
+	{
+		size_t at = static_cast<size_t>(packFile.tellp());
+		packFile.write(padding, table[k].offset - at);
+		packFile.write(reinterpret_cast<const char*>(levels[k].pixels.data()), levels[k].pixels.size());
+	}
+	return static_cast<bool>(packFile);
+}
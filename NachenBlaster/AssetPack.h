@@ -0,0 +1,91 @@
+#ifndef ASSETPACK_H_
+#define ASSETPACK_H_
+
+#include "SpriteAtlas.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+  // Asset pack file format (little-endian, every part 8-byte aligned):
+  //
+  //   Header							"NBAP" version numSprites numLevels numSources
+  //   SourceStamp[numSources]			size and modification time of each source file
+  //   AtlasSprite[numSprites]			where each sprite is in the atlas
+  //   PackLevel[numLevels]				size and file offset of each mip level
+  //   pixels of each level				RGBA, bottom row first, 16-byte aligned
+  //
+  // The pack is the sprite atlas exactly as it is handed to the renderer,
+  // mip levels included, so loading it is just mapping the file.  It is
+  // read in place, so a big-endian machine sees a bad version and rejects it.
+  // The source stamps say what the TGA files the pack was built from
+  // looked like, so that a pack older than its sources can be told apart
+  // with a stat of each file rather than by reading them.
+
+const char ASSET_PACK_FILENAME[] = "sprites.pack";
+
+class AssetPack
+{
+  public:
+	AssetPack();
+	~AssetPack();
+
+	  // Map the file (on Windows, read it with one read) and check it
+	bool open(std::string filename);
+	void close();
+
+	  // Valid until close(); the pixels point into the mapped file
+	const AtlasView& view() const
+	{
+		return m_view;
+	}
+
+	struct SourceStamp
+	{
+		std::uint64_t size;
+		std::int64_t  modified;		// seconds since the epoch
+	};
+
+	  // Stamp the file as it is now; false if it cannot be found
+	static bool stampFile(std::string filename, SourceStamp& stamp);
+
+	  // Whether the pack was built from source files stamped as given
+	bool matchesSources(const std::vector<SourceStamp>& sources) const;
+
+	static bool write(std::string filename, const SpriteAtlas& atlas, const std::vector<SourceStamp>& sources);
+
+	struct Header
+	{
+		char		  magic[4];
+		std::uint32_t version;
+		std::uint32_t numSprites;
+		std::uint32_t numLevels;
+		std::uint32_t numSources;
+		std::uint32_t reserved;
+	};
+
+	struct PackLevel
+	{
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint64_t offset;
+	};
+
+	static const std::uint32_t VERSION = 2;
+
+  private:
+	const unsigned char* m_data;
+	std::size_t			 m_size;
+	bool				 m_mapped;
+	std::vector<std::uint64_t> m_buffer;	// the file's contents, if not mapped
+	AtlasView			 m_view;
+	const SourceStamp*	 m_sources;		// in the file
+	std::size_t			 m_numSources;
+
+	bool parse();
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+};
+
+#endif // ASSETPACK_H_
@@ -0,0 +1,357 @@
+#include "AudioMixer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#if defined(__unix__)
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#endif
+using namespace std;
+
+  // Little-endian readers for the .wav header fields
+
+static uint32_t readU32(const unsigned char* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readU16(const unsigned char* p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static void writeU32(unsigned char* p, uint32_t v)
+{
+	for (int k = 0; k < 4; k++)
+		p[k] = static_cast<unsigned char>(v >> (8 * k));
+}
+
+static void writeU16(unsigned char* p, uint16_t v)
+{
+	p[0] = static_cast<unsigned char>(v);
+	p[1] = static_cast<unsigned char>(v >> 8);
+}
+
+bool AudioMixer::decodeWav(string filename, AudioClip& clip)
+{
+	ifstream ifs(filename, ios::binary);
+	if (!ifs)
+		return false;
+	vector<unsigned char> file((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+	if (file.size() < 12  ||  readU32(&file[0]) != 0x46464952  ||	// "RIFF"
+								readU32(&file[8]) != 0x45564157)		// "WAVE"
+		return false;
+
+	int format = 0, channels = 0, rate = 0, bits = 0;
+	const unsigned char* data = nullptr;
+	size_t dataBytes = 0;
+	for (size_t pos = 12; pos + 8 <= file.size(); )
+	{
+		uint32_t id = readU32(&file[pos]);
+		size_t size = readU32(&file[pos+4]);
+		size_t body = pos + 8;
+		if (size > file.size() - body)
+			size = file.size() - body;
+		if (id == 0x20746d66  &&  size >= 16)	// "fmt "
+		{
+			format = readU16(&file[body]);
+			channels = readU16(&file[body+2]);
+			rate = readU32(&file[body+4]);
+			bits = readU16(&file[body+14]);
+		}
+		else if (id == 0x61746164)	// "data"
+		{
+			data = &file[body];
+			dataBytes = size;
+		}
+		pos = body + size + (size & 1);  // chunks are padded to even sizes
+	}
+
+	  // PCM (or extensible PCM), 8 or 16 bits per sample
+	if ((format != 1  &&  format != 0xFFFE)  ||  (bits != 8  &&  bits != 16)  ||
+			channels < 1  ||  rate <= 0  ||  data == nullptr)
+		return false;
+
+	size_t bytesPerFrame = channels * bits / 8;
+	size_t srcFrames = dataBytes / bytesPerFrame;
+	auto sample = [&](size_t frame, int channel) -> int
+	{
+		const unsigned char* p = data + frame * bytesPerFrame + channel * bits / 8;
+		return bits == 8 ? (p[0] - 128) * 256 : static_cast<int16_t>(readU16(p));
+	};
+
+	  // Convert to stereo at SAMPLE_RATE, interpolating linearly between
+	  // source frames
+	clip.numFrames = (srcFrames == 0 ? 0 :
+			static_cast<size_t>(static_cast<double>(srcFrames) * SAMPLE_RATE / rate));
+	clip.samples.resize(clip.numFrames * 2);
+	double step = static_cast<double>(rate) / SAMPLE_RATE;
+	for (size_t k = 0; k < clip.numFrames; k++)
+	{
+		double srcPos = k * step;
+		size_t f0 = static_cast<size_t>(srcPos);
+		if (f0 >= srcFrames)
+			f0 = srcFrames - 1;
+		size_t f1 = (f0 + 1 < srcFrames ? f0 + 1 : f0);
+		double frac = srcPos - f0;
+		for (int c = 0; c < 2; c++)
+		{
+			int channel = (c < channels ? c : 0);
+			double v = sample(f0, channel) * (1 - frac) + sample(f1, channel) * frac;
+			clip.samples[2*k + c] = static_cast<int16_t>(v);
+		}
+	}
+	return true;
+}
+
+AudioMixer::AudioMixer()
+ : m_ringHead(0), m_ringTail(0), m_output("aplay"), m_running(false), m_dropped(0),
+   m_numVoices(0), m_accumulator(FRAMES_PER_PERIOD * 2), m_period(FRAMES_PER_PERIOD * 2)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+	if (m_running)
+	{
+		m_running = false;
+		m_thread.join();
+	}
+}
+
+const AudioClip* AudioMixer::load(string filename)
+{
+	auto p = m_clips.find(filename);
+	if (p != m_clips.end())
+		return p->second.get();
+	unique_ptr<AudioClip> clip(new AudioClip);
+	if (!decodeWav(filename, *clip))
+		clip.reset();
+	  // remember failures too, so a missing file is only looked for once
+	return (m_clips[filename] = move(clip)).get();
+}
+
+void AudioMixer::play(const AudioClip* clip)
+{
+	if (clip == nullptr  ||  clip->numFrames == 0)
+		return;
+	if (!m_running)
+		start();
+	post(clip);
+}
+
+void AudioMixer::stopAll()
+{
+	if (m_running)
+		post(nullptr);
+}
+
+bool AudioMixer::post(const AudioClip* clip)
+{
+	size_t tail = m_ringTail.load(memory_order_relaxed);
+	if (tail - m_ringHead.load(memory_order_acquire) == RING_SIZE)
+	{
+		m_dropped++;
+		return false;
+	}
+	m_ring[tail % RING_SIZE].clip = clip;
+	m_ringTail.store(tail + 1, memory_order_release);
+	return true;
+}
+
+void AudioMixer::start()
+{
+	if (m_output == "null")
+		m_device.reset(new NullAudioDevice);
+#if defined(__unix__)
+	else if (m_output == "aplay")
+	{
+		PipeAudioDevice* pipe = new PipeAudioDevice;
+		m_device.reset(pipe);
+		if (!pipe->open())
+			m_device.reset(new NullAudioDevice);
+	}
+#endif
+	else
+	{
+		WavFileAudioDevice* file = new WavFileAudioDevice;
+		m_device.reset(file);
+		if (!file->open(m_output))
+			m_device.reset(new NullAudioDevice);
+	}
+	m_running = true;
+	m_thread = thread(&AudioMixer::mixLoop, this);
+}
+
+void AudioMixer::mixLoop()
+{
+#if defined(__unix__)
+	  // If the output process goes away, have write() fail instead of
+	  // killing the game with SIGPIPE
+	sigset_t pipeSignal;
+	sigemptyset(&pipeSignal);
+	sigaddset(&pipeSignal, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+#endif
+	const chrono::nanoseconds period(1000000000LL * FRAMES_PER_PERIOD / SAMPLE_RATE);
+	auto deadline = chrono::steady_clock::now();
+	while (m_running)
+	{
+		takeCommands();
+		mixPeriod();
+		if (!m_device->write(&m_period[0], FRAMES_PER_PERIOD))
+		{
+			m_device.reset(new NullAudioDevice);
+			deadline = chrono::steady_clock::now();
+		}
+		if (!m_device->isPaced())
+		{
+			deadline += period;
+			this_thread::sleep_until(deadline);
+		}
+	}
+}
+
+void AudioMixer::takeCommands()
+{
+	size_t head = m_ringHead.load(memory_order_relaxed);
+	size_t tail = m_ringTail.load(memory_order_acquire);
+	for ( ; head != tail; head++)
+	{
+		const AudioClip* clip = m_ring[head % RING_SIZE].clip;
+		if (clip == nullptr)
+			m_numVoices = 0;
+		else
+		{
+			  // with every voice busy, the clip that started first gives way
+			if (m_numVoices == MAX_VOICES)
+			{
+				copy(m_voices + 1, m_voices + MAX_VOICES, m_voices);
+				m_numVoices--;
+			}
+			m_voices[m_numVoices].clip = clip;
+			m_voices[m_numVoices].nextFrame = 0;
+			m_numVoices++;
+		}
+	}
+	m_ringHead.store(head, memory_order_release);
+}
+
+void AudioMixer::mixPeriod()
+{
+	fill(m_accumulator.begin(), m_accumulator.end(), 0);
+	int kept = 0;
+	for (int v = 0; v < m_numVoices; v++)
+	{
+		Voice& voice = m_voices[v];
+		size_t n = min<size_t>(size_t(FRAMES_PER_PERIOD), voice.clip->numFrames - voice.nextFrame);
+		const int16_t* src = &voice.clip->samples[voice.nextFrame * 2];
+		for (size_t k = 0; k < n * 2; k++)
+			m_accumulator[k] += src[k];
+		voice.nextFrame += n;
+		if (voice.nextFrame < voice.clip->numFrames)
+			m_voices[kept++] = voice;
+	}
+	m_numVoices = kept;
+	for (size_t k = 0; k < m_period.size(); k++)
+		m_period[k] = static_cast<int16_t>(max(-32768, min(32767, m_accumulator[k])));
+}
+
+WavFileAudioDevice::WavFileAudioDevice()
+ : m_file(nullptr), m_dataBytes(0)
+{
+}
+
+WavFileAudioDevice::~WavFileAudioDevice()
+{
+	if (m_file != nullptr)
+	{
+		writeHeader();	// now that the length is known
+		fclose(m_file);
+	}
+}
+
+bool WavFileAudioDevice::open(string filename)
+{
+	m_file = fopen(filename.c_str(), "wb");
+	if (m_file == nullptr)
+		return false;
+	writeHeader();
+	return true;
+}
+
+bool WavFileAudioDevice::write(const int16_t* frames, size_t numFrames)
+{
+	unsigned char bytes[AudioMixer::FRAMES_PER_PERIOD * 4];
+	while (numFrames > 0)
+	{
+		size_t n = min<size_t>(numFrames, size_t(AudioMixer::FRAMES_PER_PERIOD));
+		for (size_t k = 0; k < n * 2; k++)
+			writeU16(&bytes[2*k], static_cast<uint16_t>(frames[k]));
+		if (fwrite(bytes, 4, n, m_file) != n)
+			return false;
+		m_dataBytes += static_cast<uint32_t>(n * 4);
+		frames += n * 2;
+		numFrames -= n;
+	}
+	return true;
+}
+
+void WavFileAudioDevice::writeHeader()
+{
+	unsigned char h[44];
+	writeU32(h, 0x46464952);		// "RIFF"
+	writeU32(h+4, 36 + m_dataBytes);
+	writeU32(h+8, 0x45564157);		// "WAVE"
+	writeU32(h+12, 0x20746d66);		// "fmt "
+	writeU32(h+16, 16);
+	writeU16(h+20, 1);				// PCM
+	writeU16(h+22, 2);				// stereo
+	writeU32(h+24, AudioMixer::SAMPLE_RATE);
+	writeU32(h+28, AudioMixer::SAMPLE_RATE * 4);
+	writeU16(h+32, 4);
+	writeU16(h+34, 16);
+	writeU32(h+36, 0x61746164);		// "data"
+	writeU32(h+40, m_dataBytes);
+	long pos = ftell(m_file);
+	fseek(m_file, 0, SEEK_SET);
+	fwrite(h, 1, sizeof(h), m_file);
+	if (pos > 0)
+		fseek(m_file, pos, SEEK_SET);
+}
+
+#if defined(__unix__)
+
+PipeAudioDevice::PipeAudioDevice()
+ : m_pipe(nullptr)
+{
+}
+
+PipeAudioDevice::~PipeAudioDevice()
+{
+	if (m_pipe != nullptr)
+		pclose(m_pipe);
+}
+
+bool PipeAudioDevice::open()
+{
+	m_pipe = popen("aplay -q -t raw -f S16_LE -c 2 -r 44100 --buffer-time=50000 2>/dev/null", "w");
+	if (m_pipe == nullptr)
+		return false;
+	setvbuf(m_pipe, nullptr, _IONBF, 0);
+#ifdef F_SETPIPE_SZ
+	  // a small pipe keeps the delay between a clip starting and being
+	  // heard short, since write() blocks once the pipe is full
+	fcntl(fileno(m_pipe), F_SETPIPE_SZ, 4096);
+#endif
+	return true;
+}
+
+bool PipeAudioDevice::write(const int16_t* frames, size_t numFrames)
+{
+	return fwrite(frames, 4, numFrames, m_pipe) == numFrames;
+}
+
+#endif
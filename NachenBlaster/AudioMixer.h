@@ -0,0 +1,182 @@
+#ifndef AUDIOMIXER_H_
+#define AUDIOMIXER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+  // An in-process sound player.  Every clip is decoded from its .wav file
+  // once, into the mixer's own format (16-bit stereo at SAMPLE_RATE).  A
+  // dedicated thread mixes whatever clips are playing and hands the result
+  // to an AudioDevice; the game thread only posts commands to it through a
+  // lock-free ring, so playing a clip never blocks, reads a file or starts
+  // a process.
+
+struct AudioClip
+{
+	std::vector<std::int16_t> samples;	// interleaved left, right
+	std::size_t numFrames;
+};
+
+  // Where mixed audio goes.  write() is called from the mixer thread only.
+
+class AudioDevice
+{
+  public:
+	virtual ~AudioDevice()
+	{
+	}
+
+	  // Consume numFrames stereo frames; return false if the device has failed
+	virtual bool write(const std::int16_t* frames, std::size_t numFrames) = 0;
+
+	  // True if write() blocks until the audio has (nearly) been played, so
+	  // the mixer need not keep time itself
+	virtual bool isPaced() const = 0;
+};
+
+  // Discards everything; used when there is no sound hardware.
+
+class NullAudioDevice : public AudioDevice
+{
+  public:
+	virtual bool write(const std::int16_t*, std::size_t)
+	{
+		return true;
+	}
+
+	virtual bool isPaced() const
+	{
+		return false;
+	}
+};
+
+  // Records everything that would have been heard into a .wav file.
+
+class WavFileAudioDevice : public AudioDevice
+{
+  public:
+	WavFileAudioDevice();
+	~WavFileAudioDevice();
+
+	bool open(std::string filename);
+	virtual bool write(const std::int16_t* frames, std::size_t numFrames);
+
+	virtual bool isPaced() const
+	{
+		return false;
+	}
+
+  private:
+	std::FILE*	  m_file;
+	std::uint32_t m_dataBytes;
+
+	void writeHeader();
+};
+
+#if defined(__unix__)
+
+  // Streams to the system's aplay, started once for the whole session.
+
+class PipeAudioDevice : public AudioDevice
+{
+  public:
+	PipeAudioDevice();
+	~PipeAudioDevice();
+
+	bool open();
+	virtual bool write(const std::int16_t* frames, std::size_t numFrames);
+
+	virtual bool isPaced() const
+	{
+		return true;
+	}
+
+  private:
+	std::FILE* m_pipe;
+};
+
+#endif
+
+class AudioMixer
+{
+  public:
+	static const int SAMPLE_RATE = 44100;
+	static const int MAX_VOICES = 16;
+	static const std::size_t FRAMES_PER_PERIOD = 512;
+
+	AudioMixer();
+	~AudioMixer();
+
+	  // Decode a .wav file, if it hasn't been already, and return the clip
+	  // (nullptr if the file can't be read or isn't PCM).  Call this from
+	  // the game thread, ideally before anything plays.
+	const AudioClip* load(std::string filename);
+
+	static bool decodeWav(std::string filename, AudioClip& clip);
+
+	  // Choose where the mixed audio goes: "null", "aplay" (the default),
+	  // or the name of a .wav file to record into.  Takes effect when the
+	  // mixer thread starts, i.e., the first time something plays.
+	void setOutput(std::string output)
+	{
+		m_output = output;
+	}
+
+	void play(const AudioClip* clip);
+	void stopAll();
+
+	  // The number of commands dropped because the ring was full
+	unsigned long getDroppedCommands() const
+	{
+		return m_dropped;
+	}
+
+  private:
+	struct Command
+	{
+		const AudioClip* clip;	// nullptr means stop everything
+	};
+
+	struct Voice
+	{
+		const AudioClip* clip;
+		std::size_t		 nextFrame;
+	};
+
+	  // Single-producer (game thread), single-consumer (mixer thread) ring
+	static const std::size_t RING_SIZE = 64;	// a power of 2
+	Command					 m_ring[RING_SIZE];
+	std::atomic<std::size_t> m_ringHead;	// next slot the mixer reads
+	std::atomic<std::size_t> m_ringTail;	// next slot the game writes
+
+	std::map<std::string, std::unique_ptr<AudioClip>> m_clips;
+	std::string					 m_output;
+	std::unique_ptr<AudioDevice> m_device;
+	std::thread					 m_thread;
+	std::atomic<bool>			 m_running;
+	unsigned long				 m_dropped;
+
+	  // Used only by the mixer thread
+	Voice					  m_voices[MAX_VOICES];
+	int						  m_numVoices;
+	std::vector<std::int32_t> m_accumulator;
+	std::vector<std::int16_t> m_period;
+
+	bool post(const AudioClip* clip);
+	void start();
+	void mixLoop();
+	void takeCommands();
+	void mixPeriod();
+
+	AudioMixer(const AudioMixer&) = delete;
+	AudioMixer& operator=(const AudioMixer&) = delete;
+};
+
+#endif // AUDIOMIXER_H_
@@ -0,0 +1,41 @@
+#include "BatchRunner.h"
+#include "GameWorld.h"
+#include <atomic>
+#include <thread>
+using namespace std;
+
+BatchRunner::BatchRunner(WorldFactory createWorld, string assetDir, unsigned int numThreads)
+ : m_createWorld(createWorld), m_assetDir(assetDir), m_numThreads(numThreads)
+{
+	if (m_numThreads == 0)
+		m_numThreads = 1;
+}
+
+vector<BatchGameResult> BatchRunner::run(unsigned int numGames, uint64_t firstSeed,
+										 unsigned long maxTicks, string keyScript)
+{
+	vector<BatchGameResult> results(numGames);
+	atomic<unsigned int> nextGame(0);
+
+	auto worker = [&]()
+	{
+		for (unsigned int k = nextGame++; k < numGames; k = nextGame++)
+		{
+			GameWorld* gw = m_createWorld(m_assetDir);
+			gw->setSeed(firstSeed + k);
+			ScriptedKeySource keys(keyScript);
+			HeadlessController controller(keys);
+			results[k].seed = firstSeed + k;
+			results[k].result = controller.run(gw, maxTicks);
+			delete gw;
+		}
+	};
+
+	unsigned int numThreads = (m_numThreads < numGames ? m_numThreads : numGames);
+	vector<thread> threads;
+	for (unsigned int t = 0; t < numThreads; t++)
+		threads.push_back(thread(worker));
+	for (thread& t : threads)
+		t.join();
+	return results;
+}
@@ -0,0 +1,38 @@
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include "HeadlessController.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GameWorld;
+
+struct BatchGameResult
+{
+	std::uint64_t  seed;
+	HeadlessResult result;
+};
+
+  // Plays many independent headless games on a pool of threads.  Game k is
+  // seeded with firstSeed + k, so a batch is reproducible game by game
+  // whatever the number of threads.  Each game's world is created, run and
+  // destroyed entirely on one worker thread.
+
+class BatchRunner
+{
+  public:
+	typedef GameWorld* (*WorldFactory)(std::string assetDir);
+
+	BatchRunner(WorldFactory createWorld, std::string assetDir, unsigned int numThreads);
+
+	std::vector<BatchGameResult> run(unsigned int numGames, std::uint64_t firstSeed,
+									 unsigned long maxTicks, std::string keyScript);
+
+  private:
+	WorldFactory m_createWorld;
+	std::string	 m_assetDir;
+	unsigned int m_numThreads;
+};
+
+#endif // BATCHRUNNER_H_
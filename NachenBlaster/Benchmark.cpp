@@ -0,0 +1,239 @@
+#include "Benchmark.h"
+#include "StudentWorld.h"
+#include "HeadlessController.h"
+#include "GraphObject.h"
+#include "Collision.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+struct BenchmarkConfig
+{
+	int numAliens;
+	int numProjectiles;
+	int numStars;
+	unsigned long long seed;
+};
+
+  // Builds StudentWorlds holding a given number of each kind of actor.  The
+  // player and the aliens are given enough health that nothing dies from a
+  // hit, and the level never completes, so the world stays the same size
+  // while it is measured.  That health is kept far below INT_MAX, because
+  // the status line works with twice the player's.
+
+class WorldBenchmark
+{
+  public:
+	WorldBenchmark(const BenchmarkConfig& config)
+	 : m_config(config), m_keys("."), m_controller(m_keys), m_world(nullptr)
+	{
+	}
+
+	~WorldBenchmark()
+	{
+		delete m_world;
+	}
+
+	StudentWorld& build()
+	{
+		delete m_world;
+		m_world = new StudentWorld("");
+		StudentWorld& w = *m_world;
+		w.setController(&m_controller);
+		w.setSeed(m_config.seed);
+		w.init();
+		w.m_blaster->increaseHealth(BENCHMARK_HEALTH);
+
+		for (int k = 0; k < m_config.numAliens; k++)
+		{
+			double x = w.randInt(0, VIEW_WIDTH - 1);
+			double y = w.randInt(0, VIEW_HEIGHT - 1);
+			Alien* a;
+			switch (k % 3)
+			{
+				case 0:  a = new (w.getActorPools()) Smallgon(x, y, &w);	break;
+				case 1:  a = new (w.getActorPools()) Smoregon(x, y, &w);	break;
+				default: a = new (w.getActorPools()) Snagglegon(x, y, &w);	break;
+			}
+			a->increaseHealth(BENCHMARK_HEALTH);
+			w.addAlien(a);
+		}
+		w.curNumShips = w.maxShips = m_config.numAliens;
+		w.needDestroy = BENCHMARK_HEALTH;
+		m_explosions.clear();
+
+		for (int k = 0; k < m_config.numProjectiles; k++)
+		{
+			double x = w.randInt(0, VIEW_WIDTH - 1);
+			double y = w.randInt(0, VIEW_HEIGHT - 1);
+			if (k % 2 == 0  ||  w.m_aliens.empty())
+				w.addActor(new (w.getActorPools()) Cabbage(x, y, w.m_blaster));
+			else
+				w.addActor(new (w.getActorPools()) Turnip(x, y, w.m_aliens[k % w.m_aliens.size()]));
+		}
+
+		for (int k = 0; k < m_config.numStars; k++)
+			w.m_starField.addStar(w.randInt(0, VIEW_WIDTH - 1), w.randInt(0, VIEW_HEIGHT - 1),
+								  w.randInt(5, 50) / 100.0);
+		return w;
+	}
+
+	  // The private StudentWorld operations being measured
+
+	bool overlap(double x1, double y1, double r1, double x2, double y2, double r2)
+	{
+		return m_world->overlap(x1, y1, r1, x2, y2, r2);
+	}
+
+	void killExplosions(int count)	// kill the survivors of last time, add count, kill every other one
+	{
+		for (size_t k = 0; k < m_explosions.size(); k++)
+			m_explosions[k]->setDead();
+		m_explosions.clear();
+		size_t first = m_world->m_actors.size();	// new actors go at the end
+		for (int k = 0; k < count; k++)
+			m_world->createExplosion(k % VIEW_WIDTH, k % VIEW_HEIGHT);
+		for (size_t k = first; k < m_world->m_actors.size(); k++)
+		{
+			if ((k - first) % 2 == 0)
+				m_world->m_actors[k]->setDead();
+			else
+				m_explosions.push_back(m_world->m_actors[k]);
+		}
+	}
+
+	void removeDead()
+	{
+		m_world->removeDead();
+	}
+
+  private:
+	static const int BENCHMARK_HEALTH = 1 << 20;
+
+	BenchmarkConfig	   m_config;
+	ScriptedKeySource  m_keys;
+	HeadlessController m_controller;
+	StudentWorld*	   m_world;
+	vector<Actor*>	   m_explosions;	// the ones killExplosions left alive
+};
+
+static void report(const char* name, double totalNs, long numOps)
+{
+	cout << left << setw(24) << name << right << setw(12) << fixed << setprecision(1)
+		 << (numOps > 0 ? totalNs / numOps : 0) << " ns/op" << endl;
+}
+
+static double elapsedNs(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+int runBenchmarks(int argc, char* argv[])
+{
+	BenchmarkConfig config = { 100, 200, 1000, 1 };
+	for (int k = 1; k+1 < argc; k++)
+	{
+		if (strcmp(argv[k], "-aliens") == 0)
+			config.numAliens = atoi(argv[++k]);
+		else if (strcmp(argv[k], "-projectiles") == 0)
+			config.numProjectiles = atoi(argv[++k]);
+		else if (strcmp(argv[k], "-stars") == 0)
+			config.numStars = atoi(argv[++k]);
+		else if (strcmp(argv[k], "-seed") == 0)
+			config.seed = strtoull(argv[++k], nullptr, 10);
+	}
+	cout << "Aliens: " << config.numAliens << "  Projectiles: " << config.numProjectiles
+		 << "  Stars: " << config.numStars << endl;
+
+	const int NUM_POINTS = 4096;
+	const long NUM_QUERIES = 1000000;
+	WorldBenchmark bench(config);
+	StudentWorld& w = bench.build();
+
+	vector<double> xs(NUM_POINTS), ys(NUM_POINTS);
+	for (int k = 0; k < NUM_POINTS; k++)
+	{
+		xs[k] = w.randInt(0, VIEW_WIDTH - 1);
+		ys[k] = w.randInt(0, VIEW_HEIGHT - 1);
+	}
+
+	long hits = 0;
+	auto start = chrono::steady_clock::now();
+	for (long k = 0; k < NUM_QUERIES; k++)
+		hits += w.targetAtAlien(xs[k % NUM_POINTS], ys[k % NUM_POINTS], 4, 0);
+	report("targetAtAlien", elapsedNs(start), NUM_QUERIES);
+
+	start = chrono::steady_clock::now();
+	for (long k = 0; k < NUM_QUERIES; k++)
+		hits += w.targetAtNachenBlaster(COLLIDER_PROJECTILE, xs[k % NUM_POINTS], ys[k % NUM_POINTS], 4, 0);
+	report("targetAtNachenBlaster", elapsedNs(start), NUM_QUERIES);
+
+	start = chrono::steady_clock::now();
+	for (long k = 0; k < NUM_QUERIES; k++)
+		hits += bench.overlap(xs[k % NUM_POINTS], ys[k % NUM_POINTS], 4,
+							  xs[(k + 1) % NUM_POINTS], ys[(k + 1) % NUM_POINTS], 12);
+	report("overlap", elapsedNs(start), NUM_QUERIES);
+
+	const int NUM_CIRCLES = 64;
+	vector<double> rs(NUM_POINTS, 12);
+	start = chrono::steady_clock::now();
+	for (long k = 0; k < NUM_QUERIES; k++)
+	{
+		int first = static_cast<int>(k % (NUM_POINTS - NUM_CIRCLES));
+		hits += firstOverlap(xs[k % NUM_POINTS], ys[k % NUM_POINTS], 4,
+							 &xs[first], &ys[first], &rs[first], NUM_CIRCLES);
+	}
+	report("firstOverlap (64)", elapsedNs(start), NUM_QUERIES);
+
+	const int NUM_REMOVALS = 1000;
+	double removeNs = 0;
+	for (int k = 0; k < NUM_REMOVALS; k++)
+	{
+		bench.killExplosions(config.numProjectiles);
+		start = chrono::steady_clock::now();
+		bench.removeDead();
+		removeNs += elapsedNs(start);
+	}
+	report("removeDead", removeNs, NUM_REMOVALS);
+
+	  // Aliens fly off the left edge after a hundred or so ticks, so the
+	  // world is rebuilt (untimed) every TICKS_PER_WORLD ticks.
+	const int NUM_TICKS = 10000;
+	const int TICKS_PER_WORLD = 50;
+	double moveNs = 0;
+	StudentWorld* world = nullptr;
+	for (int k = 0; k < NUM_TICKS; k++)
+	{
+		if (k % TICKS_PER_WORLD == 0)
+			world = &bench.build();
+		start = chrono::steady_clock::now();
+		world->move();
+		world->drainEvents();
+		moveNs += elapsedNs(start);
+	}
+	report("move", moveNs, NUM_TICKS);
+
+	StudentWorld& drawn = bench.build();
+	const int NUM_DRAWS = 10000;
+	double sink = 0;
+	start = chrono::steady_clock::now();
+	for (int k = 0; k < NUM_DRAWS; k++)
+	{
+		drawn.getGraphObjects().drawAllObjects(
+			[&sink](int, int, double x, double, int, double)
+			{
+				sink += x;
+			});
+	}
+	report("drawAllObjects", elapsedNs(start), NUM_DRAWS);
+	drawn.cleanUp();
+
+	  // keep the measured results alive so the loops are not optimized away
+	if (hits + sink < 0)
+		cout << hits << sink << endl;
+	return 0;
+}
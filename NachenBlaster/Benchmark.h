@@ -0,0 +1,10 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+  // Microbenchmarks of the collision, update and draw hot paths on
+  // synthetic worlds:
+  //   NachenBlaster -bench [-aliens N] [-projectiles N] [-stars N] [-seed N]
+
+int runBenchmarks(int argc, char* argv[]);
+
+#endif // BENCHMARK_H_
@@ -0,0 +1,43 @@
+#include "Collision.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NB_COLLISION_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef NB_COLLISION_SSE2
+
+int firstOverlap(double x, double y, double r, const double xs[], const double ys[], const double rs[], int n)
+{
+    const __m128d px = _mm_set1_pd(x);
+    const __m128d py = _mm_set1_pd(y);
+    const __m128d pr = _mm_set1_pd(r);
+    const __m128d scale = _mm_set1_pd(0.75);
+    int i = 0;
+    for(; i + 2 <= n; i += 2)       //the same arithmetic as circlesOverlap, two circles per step
+    {
+        __m128d reach = _mm_mul_pd(scale, _mm_add_pd(pr, _mm_loadu_pd(rs + i)));
+        __m128d dx = _mm_sub_pd(px, _mm_loadu_pd(xs + i));
+        __m128d dy = _mm_sub_pd(py, _mm_loadu_pd(ys + i));
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        int hits = _mm_movemask_pd(_mm_cmplt_pd(d2, _mm_mul_pd(reach, reach)));
+        if(hits != 0)
+            return (hits & 1) ? i : i + 1;
+    }
+    for(; i < n; i++)
+        if(circlesOverlap(x, y, r, xs[i], ys[i], rs[i]))
+            return i;
+    return -1;
+}
+
+#else
+
+int firstOverlap(double x, double y, double r, const double xs[], const double ys[], const double rs[], int n)
+{
+    for(int i = 0; i < n; i++)
+        if(circlesOverlap(x, y, r, xs[i], ys[i], rs[i]))
+            return i;
+    return -1;
+}
+
+#endif // NB_COLLISION_SSE2
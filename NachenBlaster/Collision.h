@@ -0,0 +1,28 @@
+#ifndef COLLISION_H_
+#define COLLISION_H_
+
+//////////////COLLISION///////////////
+//two circles collide when the distance between their centers is less than
+//0.75 times the sum of their radii; compare squared distances so no square
+//root is needed
+
+inline double collisionReach(double r1, double r2)  //return the distance below which two circles collide
+{
+    return 0.75 * (r1 + r2);
+}
+
+inline bool circlesOverlap(double x1, double y1, double r1, double x2, double y2, double r2)
+{
+    double reach = collisionReach(r1, r2);
+    double dx = x1 - x2;
+    double dy = y1 - y2;
+    if(dx >= reach || dx <= -reach || dy >= reach || dy <= -reach)   //too far apart along one axis
+        return false;
+    return dx * dx + dy * dy < reach * reach;
+}
+
+int firstOverlap(double x, double y, double r, const double xs[], const double ys[], const double rs[], int n);
+//return the index of the first of the n circles (xs[i], ys[i], rs[i]) the circle collides with, or -1 if none;
+//tests two circles at a time with SSE2 where available
+
+#endif // COLLISION_H_
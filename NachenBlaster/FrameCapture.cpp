@@ -0,0 +1,43 @@
+#include "FrameCapture.h"
+#include "GameWorld.h"
+#include <cstdio>
+using namespace std;
+
+FrameCapture::FrameCapture(SoftwareRenderer& renderer, unsigned int every, string outDir,
+						   string goldenDir, int tolerance)
+ : m_renderer(renderer), m_every(every == 0 ? 1 : every), m_outDir(outDir),
+   m_goldenDir(goldenDir), m_tolerance(tolerance), m_next(nullptr), m_tick(0), m_numFrames(0)
+{
+}
+
+void FrameCapture::tickDone(GameWorld& gw)
+{
+	unsigned long tick = m_tick++;
+	if (m_next != nullptr)
+		m_next->tickDone(gw);
+	if (tick % m_every != 0)
+		return;
+
+	m_renderer.clear();
+	drawGameSprites(m_renderer, gw.getGraphObjects(), 1);
+	m_numFrames++;
+
+	string name = frameFilename(tick);
+	if (!m_outDir.empty()  &&  !saveTga(m_outDir + '/' + name, m_renderer.getFrame())  &&  m_writeFailure.empty())
+		m_writeFailure = m_outDir + '/' + name;
+	if (!m_goldenDir.empty())
+	{
+		Mismatch m = { tick, 0 };
+		if (!loadTga(m_goldenDir + '/' + name, m_golden))
+			m_mismatches.push_back(m);
+		else if ((m.pixels = countDifferingPixels(m_renderer.getFrame(), m_golden, m_tolerance)) != 0)
+			m_mismatches.push_back(m);
+	}
+}
+
+string FrameCapture::frameFilename(unsigned long tick)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "frame%06lu.tga", tick);
+	return name;
+}
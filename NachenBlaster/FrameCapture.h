@@ -0,0 +1,66 @@
+#ifndef FRAMECAPTURE_H_
+#define FRAMECAPTURE_H_
+
+#include "HeadlessController.h"
+#include "SoftwareRenderer.h"
+#include <string>
+#include <vector>
+
+  // Renders the world with a SoftwareRenderer after every so many ticks,
+  // writing each frame as a TGA file to a directory, comparing it against
+  // the file of the same name in a directory of golden frames, or both.
+  // Frames are named by the tick just run, counting from 0 as replays do.
+
+class FrameCapture : public TickListener
+{
+  public:
+	FrameCapture(SoftwareRenderer& renderer, unsigned int every, std::string outDir,
+				 std::string goldenDir, int tolerance);
+
+	  // Pass every tick on to next as well
+	void chain(TickListener* next)
+	{
+		m_next = next;
+	}
+
+	virtual void tickDone(GameWorld& gw);
+
+	struct Mismatch
+	{
+		unsigned long tick;
+		unsigned long pixels;	// how many differ; 0 if the golden frame is missing
+	};
+
+	unsigned long getNumFrames() const
+	{
+		return m_numFrames;
+	}
+
+	const std::vector<Mismatch>& getMismatches() const
+	{
+		return m_mismatches;
+	}
+
+	  // The first frame that could not be written, or "" if none
+	const std::string& getWriteFailure() const
+	{
+		return m_writeFailure;
+	}
+
+  private:
+	SoftwareRenderer& m_renderer;
+	unsigned int	  m_every;
+	std::string		  m_outDir;
+	std::string		  m_goldenDir;
+	int				  m_tolerance;
+	TickListener*	  m_next;
+	unsigned long	  m_tick;
+	unsigned long	  m_numFrames;
+	std::vector<Mismatch> m_mismatches;
+	std::string		  m_writeFailure;
+	RgbaImage		  m_golden;
+
+	static std::string frameFilename(unsigned long tick);
+};
+
+#endif // FRAMECAPTURE_H_
@@ -2,6 +2,8 @@
 #include "GameController.h"
 #include "GameWorld.h"
 #include "GameConstants.h"
+#include "RandomGenerator.h"
+#include "Profiler.h"
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
@@ -9,6 +11,7 @@
 #include <map>
 #include <utility>
 #include <cstdlib>
+#include <cstdio>
 #include <algorithm>
 using namespace std;
 
@@ -30,21 +33,21 @@ PixelHeight = RowHeight/256 = .03375
 newSpriteHeight = PixelHeight * NumPixels
 */
 
-static const int WINDOW_WIDTH = 768; //1024;
-static const int WINDOW_HEIGHT = 768;
-
-static const int PERSPECTIVE_NEAR_PLANE = 4;
-static const int PERSPECTIVE_FAR_PLANE	= 22;
-
 static const double FONT_SCALEDOWN = 760.0;
 
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
-static const int MS_PER_FRAME = 5;
+static const int MS_PER_FRAME = 5;		// how often the scheduler is polled
+
+static const double STATS_X = -4.0;
+static const double STATS_Y = -4.0;
+static const double STATS_SIZE = .5;
 
 static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void outputStroke(double x, double y, double z, double size, const char* str);
+static void outputStrokeCentered(double y, double z, const char* str);
+static void drawScoreAndLives(GLuint gameStatList);
 
 enum GameController::GameControllerState : int {
 	welcome, init, makemove, animate, contgame, finishedlevel, cleanup, gameover, prompt, quit, not_applicable
@@ -52,50 +55,34 @@ enum GameController::GameControllerState : int {
 
 void GameController::initDrawersAndSounds()
 {
-	struct SpriteInfo
+	struct SoundInfo
 	{
-		int imageID;
-		int frameNum;
-		std::string tgaFileName;
-	};
-
-	SpriteInfo drawers[] = {
-		{ IID_NACHENBLASTER , 0, "ship.tga"},
-		{ IID_SMALLGON, 0, "smallgon.tga" },
-		{ IID_SMOREGON, 0, "smoregon.tga" },
-		{ IID_SNAGGLEGON, 0, "snagglegon.tga" },
-		{ IID_REPAIR_GOODIE, 0, "health.tga" },
-		{ IID_LIFE_GOODIE, 0, "life.tga" },
-		{ IID_TORPEDO_GOODIE, 0, "sonar.tga" },
-		{ IID_TORPEDO, 0, "torpedo.tga" },
-		{ IID_TURNIP, 0, "turnip.tga" },
-		{ IID_CABBAGE, 0, "cabbage.tga"},
-		{ IID_STAR, 0, "star1.tga" },
-		{ IID_EXPLOSION, 0, "explosion.tga" },
+		int soundID;
+		std::string wavFileName;
 	};
 
-	SoundMapType::value_type sounds[] = {
-		make_pair(SOUND_THEME          , "theme.wav"),
-		make_pair(SOUND_GOODIE         , "goodie.wav"),
-		make_pair(SOUND_BLAST          , "ouch.wav"),
-		make_pair(SOUND_PLAYER_SHOOT   , "laser.wav"),
-		make_pair(SOUND_ALIEN_SHOOT    , "laser2.wav"),
-		make_pair(SOUND_FINISHED_LEVEL , "finished.wav"),
-		make_pair(SOUND_DEATH          , "blowup.wav"),
-		make_pair(SOUND_TORPEDO        , "torpedo.wav"),
+	SoundInfo sounds[] = {
+		{ SOUND_THEME          , "theme.wav" },
+		{ SOUND_GOODIE         , "goodie.wav" },
+		{ SOUND_BLAST          , "ouch.wav" },
+		{ SOUND_PLAYER_SHOOT   , "laser.wav" },
+		{ SOUND_ALIEN_SHOOT    , "laser2.wav" },
+		{ SOUND_FINISHED_LEVEL , "finished.wav" },
+		{ SOUND_DEATH          , "blowup.wav" },
+		{ SOUND_TORPEDO        , "torpedo.wav" },
 	};
 
-	for (int k = 0; k < sizeof(drawers)/sizeof(drawers[0]); k++)
+	if (!loadGameSprites(*m_renderer, m_assetDir))
+		exit(1);
+	for (int k = 0; k < NUM_SOUNDS; k++)
+		m_soundHandles[k] = -1;
+	for (int k = 0; k < sizeof(sounds)/sizeof(sounds[0]); k++)
 	{
-		string path = m_gw->assetDirectory();
+		string path = m_assetDir;
 		if (!path.empty())
 			path += '/';
-		const SpriteInfo& d = drawers[k];
-		if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
-			exit(1);
+		m_soundHandles[sounds[k].soundID] = SoundFX().registerClip(path + sounds[k].wavFileName);
 	}
-	for (int k = 0; k < sizeof(sounds)/sizeof(sounds[0]); k++)
-		m_soundMap[sounds[k].first] = sounds[k].second;
 }
 
 static void doSomethingCallback()
@@ -128,11 +115,56 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 {
 	gw->setController(this);
 	m_gw = gw;
+	m_assetDir = gw->assetDirectory();
+	if (!m_recordFilename.empty())
+	{
+		if (m_recorder.start(m_recordFilename, this, gw->getSeed()))
+			gw->setController(&m_recorder);
+		else
+			cout << "Cannot write replay file " << m_recordFilename << endl;
+	}
+	runMainLoop(argc, argv, windowTitle);
+	m_recorder.finish();
+	delete m_gw;
+}
+
+void GameController::runThreaded(int argc, char* argv[], SimulationThread::WorldFactory createWorld,
+								 string assetDir, string windowTitle, function<void(GameWorld&)> setup)
+{
+	m_gw = nullptr;
+	m_assetDir = assetDir;
+	m_sim.reset(new SimulationThread(createWorld, assetDir, *this));
+	m_sim->call([this, setup](GameWorld& gw)
+	{
+		setup(gw);
+		if (!m_recordFilename.empty())
+		{
+			if (m_recorder.start(m_recordFilename, m_sim.get(), gw.getSeed()))
+			{
+				gw.setController(&m_recorder);
+				m_sim->setTickListener(&m_recorder);
+			}
+			else
+				cout << "Cannot write replay file " << m_recordFilename << endl;
+		}
+		return 0;
+	});
+	runMainLoop(argc, argv, windowTitle);
+	m_sim.reset();	// destroys the world on its own thread
+	m_recorder.finish();
+}
+
+void GameController::runMainLoop(int argc, char* argv[], string windowTitle)
+{
 	setGameState(welcome);
 	m_lastKeyHit = INVALID_KEY;
 	m_singleStep = false;
-	m_curIntraFrameTick = 0;
 	m_playerWon = false;
+	m_statsStart = Clock::now();
+	m_statsTicks = m_statsFrames = m_statsSkipped = 0;
+	m_statsText[0] = '\0';
+	m_gameStatTextChanged = true;
+	m_gameStatList = 0;
 
 	glutInit(&argc, argv);
 
@@ -151,7 +183,6 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
-	delete m_gw;
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
@@ -190,14 +221,8 @@ void GameController::playSound(int soundID)
 		return;
     }
 
-	SoundMapType::const_iterator p = m_soundMap.find(soundID);
-	if (p != m_soundMap.end())
-	{
-		string path = m_gw->assetDirectory();
-		if (!path.empty())
-			path += '/';
-		SoundFX().playClip(path + p->second);
-	}
+	if (soundID >= 0  &&  soundID < NUM_SOUNDS  &&  m_soundHandles[soundID] >= 0)
+		SoundFX().playClip(m_soundHandles[soundID]);
 }
 
 void GameController::setGameState(GameControllerState s)
@@ -233,7 +258,7 @@ void GameController::doSomething()
 			break;
 		case init:
 			{
-				int status = m_gw->init();
+				int status = worldCall([](GameWorld& gw) { return gw.init(); });
 				SoundFX().abortClip();
 				if (status == GWSTATUS_PLAYER_WON)
 				{
@@ -245,41 +270,22 @@ void GameController::doSomething()
 						"Error in level data file encoding!",
 						"Press Enter to quit...");
 				else
+				{
+					startScheduler();
 					setGameState(makemove);
+				}
 			}
 			break;
 		case makemove:
-			m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-			m_nextStateAfterAnimate = not_applicable;
-			{
-				int status = m_gw->move();
-				if (status == GWSTATUS_PLAYER_DIED)
-				{
-					  // animate one last frame so the player can see what happened
-					m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
-				}
-				else if (status == GWSTATUS_FINISHED_LEVEL)
-				{
-					m_gw->advanceToNextLevel();
-					  // animate one last frame so the player can see what happened
-					m_nextStateAfterAnimate = finishedlevel;
-				}
-			}
-			setGameState(animate);
+			if (m_sim)
+				runThreadedFrame();
+			else
+				runScheduledTicks();
 			break;
 		case animate:
-			displayGamePlay();
-			if (m_curIntraFrameTick-- <= 0)
-			{
-				if (m_nextStateAfterAnimate != not_applicable)
-					setGameState(m_nextStateAfterAnimate);
-				else
-				{
-					int key;
-					if (!m_singleStep  ||  getLastKey(key))
-						setGameState(makemove);
-				}
-			}
+			  // draw one last frame so the player can see what happened
+			displayGamePlay(m_sim ? &m_sim->latestSnapshot() : nullptr, 1);
+			setGameState(m_nextStateAfterAnimate);
 			break;
 		case contgame:
 			setGameStateAfterPrompting(cleanup, "You lost a life!",
@@ -290,16 +296,16 @@ void GameController::doSomething()
 										"Press Enter to continue playing...");
 			break;
 		case cleanup:
-			m_gw->cleanUp();
+			worldCall([](GameWorld& gw) { gw.cleanUp(); return 0; });
 			setGameState(init);
 			break;
 		case gameover:
 			{
 				ostringstream oss;
 				oss << (m_playerWon ? "You won the game!" : "Game Over!")
-					<< " Final score: " << m_gw->getScore() << "!";
+					<< " Final score: " << worldCall([](GameWorld& gw) { return static_cast<int>(gw.getScore()); }) << "!";
 				setGameStateAfterPrompting(quit, oss.str(), "Press Enter to quit...");
-				m_gw->cleanUp();
+				worldCall([](GameWorld& gw) { gw.cleanUp(); return 0; });
 			}
 			break;
 		case prompt:
@@ -311,14 +317,179 @@ void GameController::doSomething()
 			}
 			break;
 		case quit:
+			m_sim.reset();	// so nothing else plays a sound
             SoundFX().abortClip();
 			glutLeaveMainLoop();
 			break;
 	}
 }
 
-void GameController::displayGamePlay()
+int GameController::worldCall(function<int(GameWorld&)> op)
+{
+	return m_sim ? m_sim->call(op) : op(*m_gw);
+}
+
+void GameController::startScheduler()
+{
+	m_tickAccumulator = 0;
+	m_lastUpdate = m_nextFrame = Clock::now();
+	if (m_sim)
+	{
+		m_sim->play(m_tickInterval, m_interpolate);
+		m_lastSnapshotTick = m_sim->latestSnapshot().tick;
+	}
+}
+
+  // Run as many ticks as the real time since the last call calls for, then
+  // draw if a frame is due.  Under load several ticks run between frames.
+
+void GameController::runScheduledTicks()
+{
+	Clock::time_point now = Clock::now();
+	int ticksDue;
+	if (m_singleStep)
+	{
+		int key;
+		ticksDue = (getLastKey(key) ? 1 : 0);
+		m_tickAccumulator = 0;
+	}
+	else
+	{
+		m_tickAccumulator += chrono::duration<double>(now - m_lastUpdate).count();
+		ticksDue = static_cast<int>(m_tickAccumulator / m_tickInterval);
+		if (ticksDue > MAX_TICKS_PER_UPDATE)
+		{
+			  // too far behind to catch up (e.g., the window was being
+			  // dragged), so let the game fall behind real time instead
+			ticksDue = MAX_TICKS_PER_UPDATE;
+			m_tickAccumulator = ticksDue * m_tickInterval;
+		}
+		m_tickAccumulator -= ticksDue * m_tickInterval;
+	}
+	m_lastUpdate = now;
+
+	for (int k = 0; k < ticksDue; k++)
+	{
+		m_statsTicks++;
+		if (!tick())
+			return;
+	}
+
+	if (frameDue(now))
+	{
+		bool blend = m_interpolate  &&  !m_singleStep;
+		displayGamePlay(nullptr, blend ? m_tickAccumulator / m_tickInterval : 1);
+	}
+	updateStats(now);
+}
+
+  // With the world on the simulation thread, pass it the player's key, see
+  // whether it has stopped, and draw its latest snapshot if a frame is due.
+  // Single-stepping isn't available in this mode.
+
+void GameController::runThreadedFrame()
 {
+	int key;
+	if (getLastKey(key))
+		m_sim->pressKey(key);
+	if (m_sim->quitRequested())
+	{
+		setGameState(quit);
+		return;
+	}
+	int status;
+	if (m_sim->stopped(status))
+	{
+		endPlay(status);
+		return;
+	}
+
+	Clock::time_point now = Clock::now();
+	if (frameDue(now))
+	{
+		const RenderSnapshot& snap = m_sim->latestSnapshot();
+		m_statsTicks += snap.tick - m_lastSnapshotTick;
+		m_lastSnapshotTick = snap.tick;
+		double alpha = 1;
+		if (m_interpolate)
+			alpha = min(1.0, chrono::duration<double>(now - snap.tickTime).count() / m_tickInterval);
+		displayGamePlay(&snap, alpha);	// the same snapshot: fetching it again may swap in a newer one
+	}
+	updateStats(now);
+}
+
+  // Return true, and schedule the next frame, if it is time to draw.  If
+  // drawing is taking longer than a frame, the frames missed are dropped.
+
+bool GameController::frameDue(Clock::time_point now)
+{
+	if (now < m_nextFrame)
+		return false;
+	m_statsFrames++;
+	m_nextFrame += m_frameInterval;
+	if (m_nextFrame <= now)
+	{
+		m_statsSkipped += static_cast<unsigned int>((now - m_nextFrame) / m_frameInterval) + 1;
+		m_nextFrame = now + m_frameInterval;
+	}
+	return true;
+}
+
+  // Move the world one tick; return false if the game must leave the
+  // makemove state (the player died, finished the level, or quit).
+
+bool GameController::tick()
+{
+	if (m_interpolate)
+		m_gw->getGraphObjects().startTick();
+	int status = m_gw->move();
+	m_gw->drainEvents();
+	if (m_recorder.isRecording())
+		m_recorder.tickDone(*m_gw);
+	if (status != GWSTATUS_CONTINUE_GAME)
+	{
+		endPlay(status);
+		return false;
+	}
+	return m_gameState != quit;
+}
+
+  // The world's move() returned status: show the last frame, then prompt
+
+void GameController::endPlay(int status)
+{
+	if (status == GWSTATUS_PLAYER_DIED)
+	{
+		bool over = worldCall([](GameWorld& gw) { return gw.isGameOver() ? 1 : 0; }) != 0;
+		m_nextStateAfterAnimate = (over ? gameover : contgame);
+		setGameState(animate);
+	}
+	else if (status == GWSTATUS_FINISHED_LEVEL)
+	{
+		worldCall([](GameWorld& gw) { gw.advanceToNextLevel(); return 0; });
+		m_nextStateAfterAnimate = finishedlevel;
+		setGameState(animate);
+	}
+}
+
+void GameController::updateStats(Clock::time_point now)
+{
+	double seconds = chrono::duration<double>(now - m_statsStart).count();
+	if (seconds < 1)
+		return;
+	snprintf(m_statsText, sizeof(m_statsText), "Ticks/s: %.0f  Frames/s: %.0f  Skipped: %u",
+			 m_statsTicks / seconds, m_statsFrames / seconds, m_statsSkipped);
+	m_statsStart = now;
+	m_statsTicks = m_statsFrames = m_statsSkipped = 0;
+}
+
+  // Draw snap if it is given (the world is on the simulation thread),
+  // otherwise the world itself.
+
+void GameController::displayGamePlay(const RenderSnapshot* snap, double alpha)
+{
+	NB_PROFILE_SCOPE(PROFILE_DISPLAY);
+
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
 	glLoadIdentity();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -331,30 +502,89 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-    GraphObject::drawAllObjects(
-        [=](int imageID, int animationNumber, double x, double y, int angle, double size)
-        {
-            int frame = animationNumber % m_spriteManager.getNumFrames(imageID);
-            m_spriteManager.plotSprite(imageID, frame, x, y, angle, size);
-            
-        });
-
-	drawScoreAndLives(m_gameStatText);
+	if (m_software)
+		m_software->clear();
+	if (snap != nullptr)
+		drawSnapshot(*snap, alpha);
+	else
+		drawGameSprites(*m_renderer, m_gw->getGraphObjects(), alpha);
+	if (m_software)
+		drawSoftwareFrame();
+
+	  // Stroking the text is costly, so it is compiled into a display list
+	  // that is rebuilt only when the text changes.
+	if (m_gameStatTextChanged)
+	{
+		if (m_gameStatList == 0)
+			m_gameStatList = glGenLists(1);
+		glNewList(m_gameStatList, GL_COMPILE);
+		outputStrokeCentered(SCORE_Y, SCORE_Z, m_gameStatText.c_str());
+		glEndList();
+		m_gameStatTextChanged = false;
+	}
+	drawScoreAndLives(m_gameStatList);
+	if (m_showStats)
+		outputStroke(STATS_X, STATS_Y, SCORE_Z, STATS_SIZE, m_statsText);
 
 	glutSwapBuffers();
 }
 
+  // Draw what the simulation thread published for its latest tick
+
+void GameController::drawSnapshot(const RenderSnapshot& snap, double alpha)
+{
+	int depth = -1;
+	for (const SnapshotSprite& s : snap.sprites)
+	{
+		if (s.depth != depth  &&  depth != -1)
+			m_renderer->flushSprites();
+		depth = s.depth;
+		int frame = s.animationNumber % m_renderer->getNumFrames(s.imageID);
+		m_renderer->queueSprite(s.imageID, frame, s.prevX + (s.x - s.prevX) * alpha,
+								s.prevY + (s.y - s.prevY) * alpha, s.direction, s.size);
+	}
+	if (depth != -1)
+		m_renderer->flushSprites();
+	setGameStatText(snap.statText);
+}
+
+  // Copy the software renderer's frame to the window, under the text
+
+void GameController::drawSoftwareFrame()
+{
+	const RgbaImage& frame = m_software->getFrame();
+	glPushAttrib(GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glRasterPos2i(-1, -1);
+	glPixelZoom(static_cast<GLfloat>(m_windowWidth) / frame.width,
+				static_cast<GLfloat>(m_windowHeight) / frame.height);
+	glDrawPixels(frame.width, frame.height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopAttrib();
+}
+
 void GameController::reshape (int w, int h)
 {
+	m_windowWidth = w;
+	m_windowHeight = h;
 	glViewport (0, 0, (GLsizei) w, (GLsizei) h);
 	glMatrixMode (GL_PROJECTION);
 	glLoadIdentity ();
 #ifdef _MSC_VER
-	gluPerspective(45.0, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
+	gluPerspective(PERSPECTIVE_FOVY, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
 #else
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-	gluPerspective(45.0, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
+	gluPerspective(PERSPECTIVE_FOVY, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
 #pragma GCC diagnostic pop
 #endif
 	glMatrixMode (GL_MODELVIEW);
@@ -379,10 +609,10 @@ static void doOutputStroke(double x, double y, double z, double size, const char
 	glPopMatrix();
 }
 
-//static void outputStroke(double x, double y, double z, double size, const char* str)
-//{
-//	doOutputStroke(x, y, z, size, str, false);
-//}
+static void outputStroke(double x, double y, double z, double size, const char* str)
+{
+	doOutputStroke(x, y, z, size, str, false);
+}
 
 static void outputStrokeCentered(double y, double z, const char* str)
 {
@@ -399,14 +629,15 @@ static void drawPrompt(string mainMessage, string secondMessage)
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(GLuint gameStatList)
 {
 	static int RATE = 1;
+	static RandomGenerator flicker(RandomGenerator::randomSeed());
 	static GLfloat rgb[3] =
 		{ static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
 	for (int k = 0; k < 3; k++)
 	{
-		double strength = rgb[k] + randInt(-RATE, RATE) / 100.0;
+		double strength = rgb[k] + flicker.randInt(-RATE, RATE) / 100.0;
 		if (strength < .6)
 			strength = .6;
 		else if (strength > 1.0)
@@ -414,5 +645,5 @@ static void drawScoreAndLives(string gameStatText)
 		rgb[k] = static_cast<GLfloat>(strength);
 	}
 	glColor3f(rgb[0], rgb[1], rgb[2]);
-	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
+	glCallList(gameStatList);
 }
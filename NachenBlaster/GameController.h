@@ -1,23 +1,81 @@
 #ifndef GAMECONTROLLER_H_
 #define GAMECONTROLLER_H_
 
+#include "GameConstants.h"
 #include "SpriteManager.h"
+#include "SoftwareRenderer.h"
+#include "WorldController.h"
+#include "Replay.h"
+#include "SimulationThread.h"
 #include <string>
 #include <map>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <iostream>
 #include <sstream>
 
-const int INVALID_KEY = 0;
-
 class GraphObject;
 class GameWorld;
 
-class GameController
+class GameController : public WorldController
 {
   public:
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
 
-	bool getLastKey(int& value)
+	  // Like run(), but the world is created by createWorld on a thread of
+	  // its own and moves there at the tick rate, whether or not drawing
+	  // keeps up; the window draws the snapshots it publishes.  setup is
+	  // called on the world before play starts.
+	void runThreaded(int argc, char* argv[], SimulationThread::WorldFactory createWorld,
+					 std::string assetDir, std::string windowTitle,
+					 std::function<void(GameWorld&)> setup);
+
+	  // Record the session run() is about to play into a replay file
+	void recordTo(std::string filename)
+	{
+		m_recordFilename = filename;
+	}
+
+	  // The world moves ticksPerSecond times a second of real time, however
+	  // long drawing takes; the playfield is redrawn up to framesPerSecond
+	  // times a second, skipping frames if drawing can't keep up.
+	void setTickRate(double ticksPerSecond)
+	{
+		if (ticksPerSecond > 0)
+			m_tickInterval = 1 / ticksPerSecond;
+	}
+
+	void setFrameRate(double framesPerSecond)
+	{
+		if (framesPerSecond > 0)
+			m_frameInterval = std::chrono::duration_cast<Clock::duration>(
+								std::chrono::duration<double>(1 / framesPerSecond));
+	}
+
+	  // Draw objects part way between their positions at the last two ticks,
+	  // according to how far real time has got towards the next tick, so
+	  // motion looks smooth even at a low tick rate
+	void setInterpolation(bool interpolate)
+	{
+		m_interpolate = interpolate;
+	}
+
+	  // Draw the sprites on the CPU, as an offscreen render would, and copy
+	  // the result to the window
+	void useSoftwareRenderer(bool software)
+	{
+		m_software.reset(software ? new SoftwareRenderer : nullptr);
+		m_renderer = (software ? static_cast<Renderer*>(m_software.get()) : &m_spriteManager);
+	}
+
+	  // Show the measured ticks and frames per second under the playfield
+	void showStats(bool show)
+	{
+		m_showStats = show;
+	}
+
+	virtual bool getLastKey(int& value)
 	{
 		if (m_lastKeyHit != INVALID_KEY)
 		{
@@ -28,11 +86,15 @@ class GameController
 		return false;
 	}
 
-	void playSound(int soundID);
+	virtual void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	virtual void setGameStatText(const std::string& text)
 	{
-		m_gameStatText = text;
+		if (text != m_gameStatText)
+		{
+			m_gameStatText = text;
+			m_gameStatTextChanged = true;
+		}
 	}
 
 	void doSomething();
@@ -41,7 +103,7 @@ class GameController
 	void keyboardEvent(unsigned char key, int x, int y);
 	void specialKeyboardEvent(int key, int x, int y);
 
-	void quitGame();
+	virtual void quitGame();
 
 	  // Meyers singleton pattern
 	static GameController& getInstance()
@@ -52,29 +114,69 @@ class GameController
 
 private:
 	enum GameControllerState : int;
+	typedef std::chrono::steady_clock Clock;
+
+	static const int MAX_TICKS_PER_UPDATE = 5;
 
-	GameWorld*	m_gw;
+	GameWorld*	m_gw;			// null when the world is on m_sim's thread
+	std::unique_ptr<SimulationThread> m_sim;
+	unsigned long m_lastSnapshotTick;
+	std::string m_assetDir;
 	GameControllerState	m_gameState;
 	GameControllerState	m_nextStateAfterPrompt;
 	GameControllerState	m_nextStateAfterAnimate;
 	int			m_lastKeyHit;
 	bool		m_singleStep;
-	std::string m_gameStatText;
+	std::string m_gameStatText;		// assigned in place, reusing its capacity
+	bool		m_gameStatTextChanged;
+	unsigned int m_gameStatList;	// GL display list drawing m_gameStatText
 	std::string m_mainMessage;
 	std::string m_secondMessage;
-	int			m_curIntraFrameTick;
-	using SoundMapType = std::map<int, std::string>;
 	using DrawMapType =  std::map<int, std::string>;
-	SoundMapType  m_soundMap;
+	static const int NUM_SOUNDS = SOUND_TORPEDO + 1;
+	int			  m_soundHandles[NUM_SOUNDS];	// SoundFX handle for each SOUND_*, or -1
 	bool		  m_playerWon;
 	SpriteManager m_spriteManager;
+	std::unique_ptr<SoftwareRenderer> m_software;
+	Renderer*	  m_renderer = &m_spriteManager;	// m_spriteManager or *m_software
+	int			  m_windowWidth = WINDOW_WIDTH;
+	int			  m_windowHeight = WINDOW_HEIGHT;
+	std::string	  m_recordFilename;
+	ReplayRecorder m_recorder;
+
+	  // Fixed-timestep scheduling
+	double		  m_tickInterval = 3 * 0.005;	// seconds, the pace of the old 5ms-timer loop
+	Clock::duration m_frameInterval = std::chrono::microseconds(16667);
+	double		  m_tickAccumulator;	// seconds of real time not yet simulated
+	Clock::time_point m_lastUpdate;
+	Clock::time_point m_nextFrame;
+	bool		  m_interpolate = false;
+
+	  // Ticks and frames per second, measured over the last second
+	bool		  m_showStats = false;
+	Clock::time_point m_statsStart;
+	unsigned int  m_statsTicks;
+	unsigned int  m_statsFrames;
+	unsigned int  m_statsSkipped;
+	char		  m_statsText[80];
 
 	void setGameState(GameControllerState s);
 	void setGameStateAfterPrompting(GameControllerState s,
 							std::string mainMessage, std::string secondMessage);
 
+	void runMainLoop(int argc, char* argv[], std::string windowTitle);
+	int worldCall(std::function<int(GameWorld&)> op);
 	void initDrawersAndSounds();
-	void displayGamePlay();
+	void startScheduler();
+	void runScheduledTicks();
+	void runThreadedFrame();
+	bool frameDue(Clock::time_point now);
+	bool tick();
+	void endPlay(int status);
+	void updateStats(Clock::time_point now);
+	void displayGamePlay(const RenderSnapshot* snap, double alpha);
+	void drawSnapshot(const RenderSnapshot& snap, double alpha);
+	void drawSoftwareFrame();
 };
 
 inline GameController& Game()
@@ -0,0 +1,89 @@
+#ifndef GAMEEVENTS_H_
+#define GAMEEVENTS_H_
+
+#include "GameConstants.h"
+#include <cstddef>
+
+  // Things that happen during a tick that something outside the game logic
+  // (sound, statistics) cares about.  The world posts them as they happen;
+  // the controller drains them once per frame.
+
+enum GameEventType
+{
+	EVENT_HIT, EVENT_KILL, EVENT_PICKUP, EVENT_FIRE, EVENT_LEVEL_COMPLETE,
+	NUM_GAME_EVENT_TYPES
+};
+
+inline const char* gameEventName(int type)
+{
+	static const char* names[NUM_GAME_EVENT_TYPES] = {
+		"Hits", "Kills", "Pickups", "Shots", "Levels"
+	};
+	return names[type];
+}
+
+struct GameEvent
+{
+	GameEventType type;
+	int           soundID;	// SOUND_NONE if the event is silent
+};
+
+struct GameEventStats
+{
+	unsigned long counts[NUM_GAME_EVENT_TYPES];
+	unsigned long dropped;	// events posted while the buffer was full
+};
+
+  // A fixed-capacity buffer, so posting an event never allocates.  A tick
+  // that posts more than CAPACITY events loses the excess (and counts them).
+
+class GameEventBuffer
+{
+  public:
+	static const std::size_t CAPACITY = 256;
+
+	GameEventBuffer()
+	 : m_size(0), m_dropped(0)
+	{
+	}
+
+	void post(GameEventType type, int soundID)
+	{
+		if (m_size == CAPACITY)
+		{
+			m_dropped++;
+			return;
+		}
+		m_events[m_size].type = type;
+		m_events[m_size].soundID = soundID;
+		m_size++;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	const GameEvent& operator[](std::size_t index) const
+	{
+		return m_events[index];
+	}
+
+	unsigned long dropped() const
+	{
+		return m_dropped;
+	}
+
+	void clear()
+	{
+		m_size = 0;
+		m_dropped = 0;
+	}
+
+  private:
+	GameEvent	  m_events[CAPACITY];
+	std::size_t	  m_size;
+	unsigned long m_dropped;
+};
+
+#endif // GAMEEVENTS_H_
@@ -1,5 +1,5 @@
 #include "GameWorld.h"
-#include "GameController.h"
+#include "WorldController.h"
 #include <string>
 #include <cstdlib>
 using namespace std;
@@ -16,12 +16,20 @@ bool GameWorld::getKey(int& value)
 	return gotKey;
 }
 
-void GameWorld::playSound(int soundID)
+void GameWorld::drainEvents()
 {
-	m_controller->playSound(soundID);
+	for (size_t k = 0; k < m_events.size(); k++)
+	{
+		const GameEvent& e = m_events[k];
+		m_eventStats.counts[e.type]++;
+		if (e.soundID != SOUND_NONE)
+			m_controller->playSound(e.soundID);
+	}
+	m_eventStats.dropped += m_events.dropped();
+	m_events.clear();
 }
 
-void GameWorld::setGameStatText(string text)
+void GameWorld::setGameStatText(const string& text)
 {
 	m_controller->setGameStatText(text);
 }
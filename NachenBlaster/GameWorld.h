@@ -2,11 +2,16 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
+#include "RandomGenerator.h"
+#include "StateHash.h"
+#include "GameEvents.h"
+#include "GraphObject.h"
+#include "ActorPool.h"
 #include <string>
 
 const int START_PLAYER_LIVES = 3;
 
-class GameController;
+class WorldController;
 
 class GameWorld
 {
@@ -14,8 +19,12 @@ public:
 
 	GameWorld(std::string assetDir)
 	 : m_lives(START_PLAYER_LIVES), m_score(0), m_level(1),
-	   m_controller(nullptr), m_assetDir(assetDir)
+	   m_controller(nullptr), m_assetDir(assetDir),
+	   m_rng(RandomGenerator::randomSeed())
 	{
+		for (int k = 0; k < NUM_GAME_EVENT_TYPES; k++)
+			m_eventStats.counts[k] = 0;
+		m_eventStats.dropped = 0;
 	}
 
 	virtual ~GameWorld()
@@ -26,10 +35,37 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	  // A hash of the game state, used to detect a replay diverging from
+	  // its recording.  Worlds should fold in their own state as well.
+
+	virtual std::uint64_t checksum() const
+	{
+		StateHash hash;
+		hash.add(m_lives);
+		hash.add(m_score);
+		hash.add(m_level);
+		return hash.getHash();
+	}
+
+	void setGameStatText(const std::string& text);
 
 	bool getKey(int& value);
-	void playSound(int soundID);
+
+	  // Report something that happened this tick, with the sound to play
+	  // for it.  Nothing is played until the controller drains the events.
+
+	void postEvent(GameEventType type, int soundID = SOUND_NONE)
+	{
+		m_events.post(type, soundID);
+	}
+
+	  // Return a uniformly distributed random int from min to max, inclusive,
+	  // drawn from this world's own generator
+
+	int randInt(int min, int max)
+	{
+		return m_rng.randInt(min, max);
+	}
 
 	unsigned int getLevel() const
 	{
@@ -73,22 +109,73 @@ public:
 		++m_level;
 	}
    
-	void setController(GameController* controller)
+	  // Play the sounds of the events posted since the last call, add them
+	  // to the statistics, and forget them.  Called once per frame.
+	void drainEvents();
+
+	const GameEventStats& getEventStats() const
+	{
+		return m_eventStats;
+	}
+
+	void setController(WorldController* controller)
 	{
 		m_controller = controller;
 	}
 
-	std::string assetDirectory() const
+	const std::string& assetDirectory() const
 	{
 		return m_assetDir;
 	}
+
+	void setSeed(std::uint64_t seed)
+	{
+		m_rng.setSeed(seed);
+	}
+
+	std::uint64_t getSeed() const
+	{
+		return m_rng.getSeed();
+	}
+
+	  // This world's GraphObjects, which are drawn and ticked apart from
+	  // those of any other world
+
+	GraphObjectRegistry& getGraphObjects()
+	{
+		return m_graphObjects;
+	}
+
+	const GraphObjectRegistry& getGraphObjects() const
+	{
+		return m_graphObjects;
+	}
+
+	  // The pools this world's actors are created from
+
+	ActorPools& getActorPools()
+	{
+		return m_actorPools;
+	}
+
+	const ActorPools& getActorPools() const
+	{
+		return m_actorPools;
+	}
 	
 private:
 	unsigned int	m_lives;
 	unsigned int	m_score;
 	unsigned int	m_level;
-	GameController* m_controller;
+	WorldController* m_controller;
 	std::string		m_assetDir;
+	RandomGenerator m_rng;
+	GameEventBuffer m_events;
+	GameEventStats	m_eventStats;
+	  // Being in the base class, these outlive every actor and SpriteBatch
+	  // the derived world owns.
+	GraphObjectRegistry m_graphObjects;
+	ActorPools		m_actorPools;
 };
 
 #endif // GAMEWORLD_H_
@@ -2,26 +2,137 @@
 #define GRAPHOBJ_H_
 
 #include "GameConstants.h"
-#include <set>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
 
-const int ANIMATION_POSITIONS_PER_TICK = 1;
+class GraphObject;
+class SpriteBatch;
+
+  // Every GraphObject and SpriteBatch of one world, by depth.  Each world
+  // owns one (see GameWorld::getGraphObjects) and hands it to everything
+  // it creates, so any number of worlds can exist at once, on one thread
+  // or many, and each ticks and draws only its own objects.
+
+class GraphObjectRegistry
+{
+public:
+	GraphObjectRegistry()
+	{
+	}
+
+	  // Remember where every object is as where it was before the tick
+	  // about to run, so drawing can interpolate from there.
+	void startTick();
+
+	template<typename Func>
+	void drawAllObjects(Func plotFunc) const
+	{
+		drawAllObjects(plotFunc, [](int) {});
+	}
+
+	template<typename Func, typename DepthFunc>
+	void drawAllObjects(Func plotFunc, DepthFunc depthDoneFunc) const
+	{
+		drawAllObjects(plotFunc, depthDoneFunc, 1.0);
+	}
+
+	  // depthDoneFunc(depth) is called after all objects at that depth have
+	  // been plotted, so a batching plotter can flush in back-to-front order.
+	  // Each object is plotted alpha (0 to 1) of the way from its position
+	  // at the last startTick() to its current one; with alpha 1 (or no
+	  // startTick() calls), objects are plotted where they are.
+	template<typename Func, typename DepthFunc>
+	void drawAllObjects(Func plotFunc, DepthFunc depthDoneFunc, double alpha) const;
+
+private:
+	friend class GraphObject;
+	friend class SpriteBatch;
+	static const int NUM_DEPTHS = 4;
+
+	  // Each depth's objects are kept contiguous; every object knows its slot.
+	std::vector<GraphObject*> m_graphObjects[NUM_DEPTHS];
+	std::vector<SpriteBatch*> m_spriteBatches[NUM_DEPTHS];
+
+	std::vector<GraphObject*>& getGraphObjects(int depth)
+	{
+		if (depth < NUM_DEPTHS)
+			return m_graphObjects[depth];
+		else
+			return m_graphObjects[0];
+	}
+
+	std::vector<SpriteBatch*>& getSpriteBatches(int depth)
+	{
+		if (depth < NUM_DEPTHS)
+			return m_spriteBatches[depth];
+		else
+			return m_spriteBatches[0];
+	}
+
+	  // Prevent copying or assigning registries, which objects point into
+	GraphObjectRegistry(const GraphObjectRegistry&) = delete;
+	GraphObjectRegistry& operator=(const GraphObjectRegistry&) = delete;
+};
+
+  // A group of sprites that are not GraphObjects of their own (e.g., a star
+  // field kept in flat arrays).  Each batch is drawn along with the
+  // GraphObjects at its depth.  Like a GraphObject, a sprite is drawn alpha
+  // (0 to 1) of the way from where it was before the last tick to where it
+  // is now.
+
+class SpriteBatch
+{
+protected:
+	SpriteBatch(GraphObjectRegistry& registry, int depth)
+	 : m_registry(registry), m_depth(depth)
+	{
+		m_registry.getSpriteBatches(m_depth).push_back(this);
+	}
+
+public:
+	virtual ~SpriteBatch()
+	{
+		std::vector<SpriteBatch*>& batches = m_registry.getSpriteBatches(m_depth);
+		batches.erase(std::find(batches.begin(), batches.end(), this));
+	}
+
+	virtual std::size_t getNumSprites() const = 0;
+	virtual void getSprite(std::size_t index, double alpha, int& imageID, double& x, double& y, int& dir, double& size) const = 0;
+
+private:
+	GraphObjectRegistry& m_registry;
+	int m_depth;
+
+	  // Prevent copying or assigning SpriteBatches
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+};
 
 
 class GraphObject
 {
 protected:
-	GraphObject(int imageID, double startX, double startY, int dir = 0, double size = 1.0, int depth = 0)
-	 : m_imageID(imageID), m_animationNumber(0), m_x(startX), m_y(startY),
+	GraphObject(GraphObjectRegistry& registry, int imageID, double startX, double startY,
+				int dir = 0, double size = 1.0, int depth = 0)
+	 : m_registry(registry), m_imageID(imageID), m_animationNumber(0), m_x(startX), m_y(startY),
 	   m_destX(startX), m_destY(startY), m_direction(dir),
 	   m_size(size <= 0 ? 1 : size), m_depth(depth)
 	{
-		getGraphObjects(m_depth).insert(this);
+		std::vector<GraphObject*>& objects = m_registry.getGraphObjects(m_depth);
+		m_registryIndex = objects.size();
+		objects.push_back(this);
 	}
 
 public:
 	virtual ~GraphObject()
 	{
-		getGraphObjects(m_depth).erase(this);
+		  // O(1) removal: move the last object into our slot
+		std::vector<GraphObject*>& objects = m_registry.getGraphObjects(m_depth);
+		GraphObject* last = objects.back();
+		objects[m_registryIndex] = last;
+		last->m_registryIndex = m_registryIndex;
+		objects.pop_back();
 	}
 
     double getX() const
@@ -72,62 +183,61 @@ public:
 		return RADIUS_PER_UNIT * m_size;
 	}
 
-    template<typename Func>
-    static void drawAllObjects(Func plotFunc)
-    {
-        for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
-        {
-            for (GraphObject* go : getGraphObjects(depth))
-            {
-                go->animate();
-                plotFunc(go->m_imageID, go->m_animationNumber, go->m_x, go->m_y, go->m_direction, go->m_size);
-            }
-        }
-    }
-
 private:
-    static const int NUM_DEPTHS = 4;
+    friend class GraphObjectRegistry;
+    GraphObjectRegistry& m_registry;
     int             m_imageID;
     unsigned int    m_animationNumber;
-    double          m_x;
+    double          m_x;        // where the object was before the current tick
     double          m_y;
-    double          m_destX;
+    double          m_destX;    // where it is now
     double          m_destY;
     int				m_direction;
     double          m_size;
     int             m_depth;
+    std::size_t     m_registryIndex;
 
-    void animate()
-    {
-        m_x = m_destX;
-        m_y = m_destY;
-        // moveALittle(m_x, m_destX);
-        // moveALittle(m_y, m_destY);
-    }
- 
-    void moveALittle(double& from, double& to)
-    {
-        static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
-        if (to - from >= DISTANCE)
-            from += DISTANCE;
-        else if (from - to >= DISTANCE)
-            from -= DISTANCE;
-        else
-            from = to;
-    }
-
-    static std::set<GraphObject*>& getGraphObjects(int depth)
-    {
-        static std::set<GraphObject*> m_graphObjects[NUM_DEPTHS];
-        if (depth < NUM_DEPTHS)
-            return m_graphObjects[depth];
-        else
-            return m_graphObjects[0];         // empty;
-    }
-    
       // Prevent copying or assigning GraphObjects
     GraphObject(const GraphObject&) = delete;
     GraphObject& operator=(const GraphObject&) = delete;
 };
 
+inline void GraphObjectRegistry::startTick()
+{
+	for (int depth = 0; depth < NUM_DEPTHS; depth++)
+	{
+		for (GraphObject* go : m_graphObjects[depth])
+		{
+			go->m_x = go->m_destX;
+			go->m_y = go->m_destY;
+		}
+	}
+}
+
+template<typename Func, typename DepthFunc>
+void GraphObjectRegistry::drawAllObjects(Func plotFunc, DepthFunc depthDoneFunc, double alpha) const
+{
+	for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
+	{
+		for (const SpriteBatch* batch : m_spriteBatches[depth])
+		{
+			std::size_t n = batch->getNumSprites();
+			for (std::size_t i = 0; i < n; i++)
+			{
+				int imageID, dir;
+				double x, y, size;
+				batch->getSprite(i, alpha, imageID, x, y, dir, size);
+				plotFunc(imageID, 0, x, y, dir, size);
+			}
+		}
+		for (const GraphObject* go : m_graphObjects[depth])
+		{
+			double x = go->m_x + (go->m_destX - go->m_x) * alpha;
+			double y = go->m_y + (go->m_destY - go->m_y) * alpha;
+			plotFunc(go->m_imageID, go->m_animationNumber, x, y, go->m_direction, go->m_size);
+		}
+		depthDoneFunc(depth);
+	}
+}
+
 #endif // GRAPHOBJ_H_
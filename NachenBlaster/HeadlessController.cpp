@@ -0,0 +1,120 @@
+#include "HeadlessController.h"
+#include "GameWorld.h"
+#include "GameConstants.h"
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+using namespace std;
+
+ScriptedKeySource::ScriptedKeySource(string script)
+{
+	for (char c : script)
+	{
+		switch (c)
+		{
+			case 'a':  m_keys.push_back(KEY_PRESS_LEFT);	break;
+			case 'd':  m_keys.push_back(KEY_PRESS_RIGHT);	break;
+			case 'w':  m_keys.push_back(KEY_PRESS_UP);		break;
+			case 's':  m_keys.push_back(KEY_PRESS_DOWN);	break;
+			case 't':  m_keys.push_back(KEY_PRESS_TAB);		break;
+			case '.':  m_keys.push_back(INVALID_KEY);		break;
+			case '\n': case '\r':							break;
+			default:   m_keys.push_back(c);					break;
+		}
+	}
+}
+
+int ScriptedKeySource::keyForTick(unsigned long tick)
+{
+	if (m_keys.empty())
+		return INVALID_KEY;
+	return m_keys[tick % m_keys.size()];
+}
+
+bool ScriptedKeySource::loadFromFile(string filename, string& script)
+{
+	ifstream ifs(filename);
+	if (!ifs)
+		return false;
+	ostringstream oss;
+	oss << ifs.rdbuf();
+	script = oss.str();
+	return true;
+}
+
+HeadlessController::HeadlessController(KeySource& keys)
+ : m_keys(keys), m_listener(nullptr), m_front(nullptr),
+   m_pendingKey(INVALID_KEY), m_quit(false)
+{
+}
+
+HeadlessResult HeadlessController::run(GameWorld* gw, unsigned long maxTicks)
+{
+	gw->setController(m_front != nullptr ? m_front : this);
+	m_quit = false;
+
+	HeadlessResult result;
+	result.ticks = 0;
+
+	auto start = chrono::steady_clock::now();
+
+	bool playing = startLevel(gw);
+	while (playing  &&  !m_quit  &&  result.ticks < maxTicks)
+	{
+		m_pendingKey = m_keys.keyForTick(result.ticks);
+		int status = gw->move();
+		gw->drainEvents();
+		result.ticks++;
+		if (m_listener != nullptr)
+			m_listener->tickDone(*gw);
+
+		  // mirror the GameController state machine, minus the prompts
+		if (status == GWSTATUS_PLAYER_DIED)
+		{
+			gw->cleanUp();
+			playing = !gw->isGameOver()  &&  startLevel(gw);
+		}
+		else if (status == GWSTATUS_FINISHED_LEVEL)
+		{
+			gw->advanceToNextLevel();
+			gw->cleanUp();
+			playing = startLevel(gw);
+		}
+	}
+	if (playing)
+		gw->cleanUp();
+
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	result.score = gw->getScore();
+	result.level = gw->getLevel();
+	result.events = gw->getEventStats();
+	return result;
+}
+
+bool HeadlessController::startLevel(GameWorld* gw)
+{
+	int status = gw->init();
+	if (status == GWSTATUS_PLAYER_WON  ||  status == GWSTATUS_LEVEL_ERROR)
+	{
+		gw->cleanUp();
+		return false;
+	}
+	return true;
+}
+
+bool HeadlessController::getLastKey(int& value)
+{
+	if (m_pendingKey != INVALID_KEY)
+	{
+		value = m_pendingKey;
+		m_pendingKey = INVALID_KEY;
+		return true;
+	}
+	return false;
+}
+
+void HeadlessController::quitGame()
+{
+	m_quit = true;
+}
@@ -0,0 +1,99 @@
+#ifndef HEADLESSCONTROLLER_H_
+#define HEADLESSCONTROLLER_H_
+
+#include "WorldController.h"
+#include "GameEvents.h"
+#include <string>
+#include <vector>
+
+class GameWorld;
+
+  // Supplies the key (or INVALID_KEY) the player "presses" on a given tick.
+
+class KeySource
+{
+  public:
+	virtual ~KeySource()
+	{
+	}
+
+	virtual int keyForTick(unsigned long tick) = 0;
+};
+
+  // Plays back a looping script of keyboard characters, one per tick, using
+  // the same letters the GLUT controller accepts (a/d/w/s move, t fires a
+  // torpedo, space fires a cabbage).  A '.' means no key that tick.
+
+class ScriptedKeySource : public KeySource
+{
+  public:
+	ScriptedKeySource(std::string script);
+	virtual int keyForTick(unsigned long tick);
+
+	static bool loadFromFile(std::string filename, std::string& script);
+
+  private:
+	std::vector<int> m_keys;
+};
+
+  // Told about every tick a driver runs, right after GameWorld::move().
+
+class TickListener
+{
+  public:
+	virtual ~TickListener()
+	{
+	}
+
+	virtual void tickDone(GameWorld& gw) = 0;
+};
+
+const char DEFAULT_KEY_SCRIPT[] = "  w  w  s  s t  d  a ";
+
+struct HeadlessResult
+{
+	unsigned long ticks;
+	unsigned int  score;
+	unsigned int  level;
+	double        seconds;
+	GameEventStats events;
+};
+
+  // Drives a GameWorld through init()/move()/cleanUp() as fast as possible,
+  // with no window, timer, sound or text output.
+
+class HeadlessController : public WorldController
+{
+  public:
+	HeadlessController(KeySource& keys);
+
+	HeadlessResult run(GameWorld* gw, unsigned long maxTicks);
+
+	void setTickListener(TickListener* listener)
+	{
+		m_listener = listener;
+	}
+
+	  // Have the world talk to front (e.g., a ReplayRecorder), which is
+	  // expected to pass the calls on to this controller.
+	void interpose(WorldController* front)
+	{
+		m_front = front;
+	}
+
+	virtual bool getLastKey(int& value);
+	virtual void playSound(int) {}
+	virtual void setGameStatText(const std::string&) {}
+	virtual void quitGame();
+
+  private:
+	KeySource&    m_keys;
+	TickListener* m_listener;
+	WorldController* m_front;
+	int           m_pendingKey;
+	bool          m_quit;
+
+	bool startLevel(GameWorld* gw);
+};
+
+#endif // HEADLESSCONTROLLER_H_
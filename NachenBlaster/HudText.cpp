@@ -0,0 +1,62 @@
+#include "HudText.h"
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+//each field is its label, its value and its suffix, in this order
+static const char* const LABELS[] = { "Lives: ", "  Health: ", "  Score: ", "  Level: ", "  Cabbages: ", "  Torpedoes: " };
+static const char* const SUFFIXES[] = { "", "%", "", "", "%", "" };
+
+HudText::HudText()
+{
+    for(int i = 0; i < NUM_FIELDS; i++)
+    {
+        m_fields[i].value = 0;
+        m_fields[i].formatted = false;
+        m_fields[i].length = 0;
+    }
+    m_text.reserve(sizeof(m_buffer));
+}
+
+bool HudText::update(unsigned int lives, int health, unsigned int score, unsigned int level, int cabbages, int torpedoes)
+{
+    bool changed = false;
+    changed |= setField(0, lives);
+    changed |= setField(1, health);
+    changed |= setField(2, score);
+    changed |= setField(3, level);
+    changed |= setField(4, cabbages);
+    changed |= setField(5, torpedoes);
+    if(!changed)                //nothing to rebuild
+        return false;
+    char* p = m_buffer;
+    for(int i = 0; i < NUM_FIELDS; i++)     //the fields' widths vary, so lay them all out again
+    {
+        size_t n = strlen(LABELS[i]);
+        memcpy(p, LABELS[i], n);
+        p += n;
+        memcpy(p, m_fields[i].digits, m_fields[i].length);
+        p += m_fields[i].length;
+        n = strlen(SUFFIXES[i]);
+        memcpy(p, SUFFIXES[i], n);
+        p += n;
+    }
+    m_text.assign(m_buffer, p - m_buffer);
+    return true;
+}
+
+const string& HudText::getText() const
+{
+    return m_text;
+}
+
+bool HudText::setField(int i, long long value)
+{
+    Field& f = m_fields[i];
+    if(f.formatted && f.value == value)
+        return false;
+    f.value = value;
+    f.formatted = true;
+    f.length = snprintf(f.digits, DIGITS_SIZE, "%lld", value);
+    return true;
+}
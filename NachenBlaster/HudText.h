@@ -0,0 +1,32 @@
+#ifndef HUDTEXT_H_
+#define HUDTEXT_H_
+
+#include <string>
+
+//////////////HUDTEXT///////////////
+//the status line shown above the playfield; each value is formatted only
+//when it changes, into fixed buffers, so an unchanged HUD costs nothing
+class HudText
+{
+public:
+    HudText();
+    bool update(unsigned int lives, int health, unsigned int score, unsigned int level, int cabbages, int torpedoes);
+    //store the values and rebuild the text if any of them changed; return true if the text changed
+    const std::string& getText() const; //return the current text
+private:
+    static const int NUM_FIELDS = 6;
+    static const int DIGITS_SIZE = 24;
+    struct Field
+    {
+        long long value;
+        bool formatted;                 //false until the value has been formatted once
+        char digits[DIGITS_SIZE];
+        int length;
+    };
+    bool setField(int i, long long value);  //reformat the field if its value changed; return true if it did
+    Field m_fields[NUM_FIELDS];
+    char m_buffer[NUM_FIELDS * (DIGITS_SIZE + 16)];
+    std::string m_text;                 //reserved up front, so copying the buffer in never allocates
+};
+
+#endif // HUDTEXT_H_
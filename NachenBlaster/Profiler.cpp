@@ -0,0 +1,39 @@
+#include "Profiler.h"
+
+#ifdef NB_ENABLE_PROFILING
+
+#include <cstdlib>
+#include <new>
+
+  // Replace the global allocation functions so profiling builds can count
+  // allocations.  The other forms of operator new and delete are defined
+  // by the library in terms of these.
+
+void* operator new(std::size_t size)
+{
+	Profiler::allocationCount()++;
+	if (size == 0)
+		size = 1;
+	for (;;)
+	{
+		void* p = std::malloc(size);
+		if (p != nullptr)
+			return p;
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+#endif // NB_ENABLE_PROFILING
@@ -0,0 +1,273 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+  // Optional tick-level instrumentation.  Build with NB_ENABLE_PROFILING
+  // defined to get it; otherwise NB_PROFILE_SCOPE expands to nothing and
+  // none of this is compiled.
+  //
+  // NB_PROFILE_SCOPE(phase) times the rest of the enclosing block.  Each
+  // thread has its own Profiler, which keeps the most recent samples of
+  // every phase (for p50/p99/max) and a bounded log of all timed scopes
+  // that can be written out as a Chrome trace (chrome://tracing, Perfetto).
+  // The Profilers outlive their threads, so that once a thread has been
+  // joined, what it recorded is reported along with everything else.
+  // Profiling builds also count heap allocations (see Profiler.cpp), and
+  // each phase reports how many were made while it ran.
+
+enum ProfilePhase
+{
+	PROFILE_TICK, PROFILE_INTRODUCE_STAR, PROFILE_INTRODUCE_ALIEN, PROFILE_BLASTER,
+	PROFILE_ACTORS, PROFILE_REMOVE_DEAD, PROFILE_UPDATE_TEXT, PROFILE_DISPLAY,
+	NUM_PROFILE_PHASES
+};
+
+#ifdef NB_ENABLE_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+  public:
+	  // This thread's Profiler
+	static Profiler& get()
+	{
+		static thread_local Profiler* instance = registerThread();
+		return *instance;
+	}
+
+	static const char* phaseName(int phase)
+	{
+		static const char* names[NUM_PROFILE_PHASES] = {
+			"move", "introduceStar", "introduceAlien", "blaster",
+			"actors", "removeDead", "updateText", "displayGamePlay"
+		};
+		return names[phase];
+	}
+
+	  // The number of times this thread has called operator new
+	static std::uint64_t& allocationCount()
+	{
+		static thread_local std::uint64_t count = 0;
+		return count;
+	}
+
+	  // Allocations made by this thread, not counting the profiler's own
+	std::uint64_t allocations() const
+	{
+		return allocationCount() - m_ownAllocations;
+	}
+
+	  // Nanoseconds since the first Profiler was made, so every thread's
+	  // times are on the same clock
+	std::int64_t now() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - epoch()).count();
+	}
+
+	void record(ProfilePhase phase, std::int64_t startNs, std::int64_t durationNs,
+				std::uint64_t numAllocations)
+	{
+		Window& w = m_windows[phase];
+		w.samples[w.next] = durationNs;
+		w.next = (w.next + 1) % WINDOW_SIZE;
+		w.count++;
+		w.allocations += numAllocations;
+		w.maxAllocations = std::max(w.maxAllocations, numAllocations);
+		if (m_events.size() < MAX_TRACE_EVENTS)
+		{
+			std::uint64_t before = allocationCount();
+			Event e = { phase, startNs, durationNs, numAllocations };
+			m_events.push_back(e);
+			m_ownAllocations += allocationCount() - before;
+		}
+	}
+
+	struct Summary
+	{
+		unsigned long count;	// samples ever recorded
+		double p50Us;			// over the most recent WINDOW_SIZE samples
+		double p99Us;
+		double maxUs;
+		std::uint64_t allocations;		// ever made during the phase
+		std::uint64_t maxAllocations;	// made during any one sample
+	};
+
+	Summary summarize(ProfilePhase phase) const
+	{
+		const Window& w = m_windows[phase];
+		Summary s = { w.count, 0, 0, 0, w.allocations, w.maxAllocations };
+		std::size_t n = std::min<std::size_t>(w.count, std::size_t(WINDOW_SIZE));
+		if (n == 0)
+			return s;
+		std::vector<std::int64_t> sorted(w.samples, w.samples + n);
+		std::sort(sorted.begin(), sorted.end());
+		s.p50Us = sorted[(n - 1) * 50 / 100] / 1000.0;
+		s.p99Us = sorted[(n - 1) * 99 / 100] / 1000.0;
+		s.maxUs = sorted[n - 1] / 1000.0;
+		return s;
+	}
+
+	void printSummary(std::ostream& os) const
+	{
+		for (int p = 0; p < NUM_PROFILE_PHASES; p++)
+		{
+			Summary s = summarize(static_cast<ProfilePhase>(p));
+			if (s.count == 0)
+				continue;
+			os << phaseName(p) << ": n=" << s.count << "  p50=" << s.p50Us
+			   << "us  p99=" << s.p99Us << "us  max=" << s.maxUs << "us  allocs=" << s.allocations
+			   << " (max " << s.maxAllocations << ")" << std::endl;
+		}
+	}
+
+	  // The summary of every thread that has recorded anything.  Call this,
+	  // and writeChromeTrace, only when no other thread is still profiling.
+	static void printSummaries(std::ostream& os)
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (const std::unique_ptr<Profiler>& p : r.profilers)
+		{
+			if (p->m_events.empty())
+				continue;
+			os << "Thread " << p->m_threadNumber << ":" << std::endl;
+			p->printSummary(os);
+		}
+	}
+
+	  // Each thread's scopes are on their own track, under its thread number
+	static bool writeChromeTrace(std::string filename)
+	{
+		std::ofstream ofs(filename);
+		if (!ofs)
+			return false;
+		ofs << "{\"traceEvents\":[";
+		const char* separator = "";
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (const std::unique_ptr<Profiler>& p : r.profilers)
+		{
+			for (const Event& e : p->m_events)
+			{
+				ofs << separator << "\n{\"name\":\"" << phaseName(e.phase)
+					<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << p->m_threadNumber
+					<< ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0
+					<< ",\"args\":{\"allocs\":" << e.allocations << "}}";
+				separator = ",";
+			}
+		}
+		ofs << "\n]}\n";
+		return static_cast<bool>(ofs);
+	}
+
+  private:
+	static const std::size_t WINDOW_SIZE = 1024;
+	static const std::size_t MAX_TRACE_EVENTS = 1 << 20;
+
+	struct Window
+	{
+		std::int64_t  samples[WINDOW_SIZE];
+		std::size_t	  next;
+		unsigned long count;
+		std::uint64_t allocations;
+		std::uint64_t maxAllocations;
+	};
+
+	struct Event
+	{
+		ProfilePhase phase;
+		std::int64_t startNs;
+		std::int64_t durationNs;
+		std::uint64_t allocations;
+	};
+
+	  // Every Profiler ever made, in the order their threads first used them
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Profiler>> profilers;
+	};
+
+	int m_threadNumber;		// 1 for the first thread to profile, and so on
+	Window m_windows[NUM_PROFILE_PHASES];
+	std::vector<Event> m_events;
+	std::uint64_t m_ownAllocations;
+
+	static Registry& registry()
+	{
+		static Registry r;
+		return r;
+	}
+
+	static std::chrono::steady_clock::time_point epoch()
+	{
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return start;
+	}
+
+	static Profiler* registerThread()
+	{
+		epoch();
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		r.profilers.push_back(std::unique_ptr<Profiler>(new Profiler(static_cast<int>(r.profilers.size()) + 1)));
+		return r.profilers.back().get();
+	}
+
+	Profiler(int threadNumber)
+	 : m_threadNumber(threadNumber), m_ownAllocations(0)
+	{
+		for (int p = 0; p < NUM_PROFILE_PHASES; p++)
+		{
+			m_windows[p].next = 0;
+			m_windows[p].count = 0;
+			m_windows[p].allocations = 0;
+			m_windows[p].maxAllocations = 0;
+		}
+	}
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+};
+
+class ProfileScope
+{
+  public:
+	ProfileScope(ProfilePhase phase)
+	 : m_phase(phase), m_start(Profiler::get().now()),
+	   m_startAllocations(Profiler::get().allocations())
+	{
+	}
+
+	~ProfileScope()
+	{
+		Profiler& p = Profiler::get();
+		p.record(m_phase, m_start, p.now() - m_start, p.allocations() - m_startAllocations);
+	}
+
+  private:
+	ProfilePhase  m_phase;
+	std::int64_t  m_start;
+	std::uint64_t m_startAllocations;
+};
+
+#define NB_PROFILE_CONCAT2(a, b) a##b
+#define NB_PROFILE_CONCAT(a, b) NB_PROFILE_CONCAT2(a, b)
+#define NB_PROFILE_SCOPE(phase) ProfileScope NB_PROFILE_CONCAT(profileScope_, __LINE__)(phase)
+
+#else
+
+#define NB_PROFILE_SCOPE(phase) ((void)0)
+
+#endif // NB_ENABLE_PROFILING
+
+#endif // PROFILER_H_
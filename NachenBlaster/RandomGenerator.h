@@ -0,0 +1,97 @@
+#ifndef RANDOMGENERATOR_H_
+#define RANDOMGENERATOR_H_
+
+#include <cstdint>
+#include <random>
+#include <utility>
+
+  // A small, fast, seedable generator (xoshiro256**).  Each GameWorld owns
+  // one, so a game's randomness is reproducible from its seed and is not
+  // shared with anything else in the process.
+
+class RandomGenerator
+{
+  public:
+	explicit RandomGenerator(std::uint64_t seed = 0)
+	{
+		setSeed(seed);
+	}
+
+	void setSeed(std::uint64_t seed)
+	{
+		m_seed = seed;
+		  // expand the seed into the generator state with splitmix64
+		for (int k = 0; k < 4; k++)
+		{
+			seed += 0x9e3779b97f4a7c15ULL;
+			std::uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			m_state[k] = z ^ (z >> 31);
+		}
+	}
+
+	std::uint64_t getSeed() const
+	{
+		return m_seed;
+	}
+
+	std::uint64_t next()
+	{
+		std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+		std::uint64_t t = m_state[1] << 17;
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3] = rotl(m_state[3], 45);
+		return result;
+	}
+
+	  // Return a uniformly distributed random int from min to max, inclusive
+
+	int randInt(int min, int max)
+	{
+		if (max < min)
+			std::swap(max, min);
+		std::uint32_t range = static_cast<std::uint32_t>(
+						static_cast<std::int64_t>(max) - min + 1);
+		if (range == 0)		// the whole int range
+			return static_cast<int>(static_cast<std::uint32_t>(next() >> 32));
+
+		  // Lemire's multiply-and-shift bounded draw, rejecting the few
+		  // values that would make it biased
+		std::uint64_t m = (next() >> 32) * range;
+		std::uint32_t low = static_cast<std::uint32_t>(m);
+		if (low < range)
+		{
+			std::uint32_t threshold = (0u - range) % range;
+			while (low < threshold)
+			{
+				m = (next() >> 32) * range;
+				low = static_cast<std::uint32_t>(m);
+			}
+		}
+		return static_cast<int>(min + static_cast<std::int64_t>(m >> 32));
+	}
+
+	  // A seed for when the user did not ask for a particular one
+
+	static std::uint64_t randomSeed()
+	{
+		std::random_device rd;
+		return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+	}
+
+  private:
+	std::uint64_t m_seed;
+	std::uint64_t m_state[4];
+
+	static std::uint64_t rotl(std::uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+#endif // RANDOMGENERATOR_H_
@@ -0,0 +1,120 @@
+#include "Renderer.h"
+#include "GraphObject.h"
+#include "AssetPack.h"
+using namespace std;
+
+  // Every sprite the game draws, and the TGA file it comes from
+
+struct SpriteInfo
+{
+	int imageID;
+	int frameNum;
+	const char* tgaFileName;
+};
+
+static const SpriteInfo gameSprites[] = {
+	{ IID_NACHENBLASTER , 0, "ship.tga"},
+	{ IID_SMALLGON, 0, "smallgon.tga" },
+	{ IID_SMOREGON, 0, "smoregon.tga" },
+	{ IID_SNAGGLEGON, 0, "snagglegon.tga" },
+	{ IID_REPAIR_GOODIE, 0, "health.tga" },
+	{ IID_LIFE_GOODIE, 0, "life.tga" },
+	{ IID_TORPEDO_GOODIE, 0, "sonar.tga" },
+	{ IID_TORPEDO, 0, "torpedo.tga" },
+	{ IID_TURNIP, 0, "turnip.tga" },
+	{ IID_CABBAGE, 0, "cabbage.tga"},
+	{ IID_STAR, 0, "star1.tga" },
+	{ IID_EXPLOSION, 0, "explosion.tga" },
+};
+
+static const size_t NUM_GAME_SPRITES = sizeof(gameSprites)/sizeof(gameSprites[0]);
+
+static string assetPath(string assetDir)
+{
+	if (!assetDir.empty())
+		assetDir += '/';
+	return assetDir;
+}
+
+bool buildGameSpriteAtlas(string assetDir, SpriteAtlas& atlas)
+{
+	string path = assetPath(assetDir);
+	vector<SpriteAtlas::Source> sources(NUM_GAME_SPRITES);
+	for (size_t k = 0; k < NUM_GAME_SPRITES; k++)
+	{
+		const SpriteInfo& d = gameSprites[k];
+		sources[k].imageID = d.imageID;
+		sources[k].frameNum = d.frameNum;
+		if (!loadTga(path + d.tgaFileName, sources[k].image))
+			return false;
+	}
+	return atlas.build(sources);
+}
+
+  // Only the files' sizes and modification times are looked at, so that
+  // checking a pack costs a stat of each file rather than reading them.
+
+bool stampGameSpriteSources(string assetDir, vector<AssetPack::SourceStamp>& stamps)
+{
+	string path = assetPath(assetDir);
+	stamps.resize(NUM_GAME_SPRITES);
+	for (size_t k = 0; k < NUM_GAME_SPRITES; k++)
+	{
+		if (!AssetPack::stampFile(path + gameSprites[k].tgaFileName, stamps[k]))
+			return false;
+	}
+	return true;
+}
+
+  // Whether atlas has every sprite the game draws, so none would go missing
+  // (or have no frames to animate through) were it loaded.
+
+static bool hasEveryGameSprite(const AtlasView& atlas)
+{
+	for (size_t k = 0; k < NUM_GAME_SPRITES; k++)
+	{
+		bool found = false;
+		for (size_t i = 0; i < atlas.numSprites  &&  !found; i++)
+			found = (atlas.sprites[i].imageID == gameSprites[k].imageID  &&
+					 atlas.sprites[i].frameNum == gameSprites[k].frameNum);
+		if (!found)
+			return false;
+	}
+	return true;
+}
+
+  // A pack is used only if the TGA files are stamped as they were when it
+  // was built
+  // and has every sprite; otherwise the TGA files are loaded, just as if
+  // there were no pack.
+
+bool loadGameSprites(Renderer& renderer, string assetDir)
+{
+	AssetPack pack;
+	vector<AssetPack::SourceStamp> stamps;
+	if (pack.open(assetPath(assetDir) + ASSET_PACK_FILENAME)  &&
+		stampGameSpriteSources(assetDir, stamps)  &&
+		pack.matchesSources(stamps)  &&
+		hasEveryGameSprite(pack.view()))
+		return renderer.loadAtlas(pack.view());
+
+	SpriteAtlas atlas;
+	return buildGameSpriteAtlas(assetDir, atlas)  &&  renderer.loadAtlas(atlas.view());
+}
+
+  // Sprites are queued and submitted once per depth.
+
+void drawGameSprites(Renderer& renderer, const GraphObjectRegistry& objects, double alpha)
+{
+	objects.drawAllObjects(
+		[&renderer](int imageID, int animationNumber, double x, double y, int angle, double size)
+		{
+			int frame = animationNumber % renderer.getNumFrames(imageID);
+			renderer.queueSprite(imageID, frame, x, y, angle, size);
+		},
+		[&renderer](int)
+		{
+			renderer.flushSprites();
+		},
+		alpha);
+}
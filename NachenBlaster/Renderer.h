@@ -0,0 +1,103 @@
+#ifndef RENDERER_H_
+#define RENDERER_H_
+
+#include "GameConstants.h"
+#include "AssetPack.h"
+#include <string>
+#include <vector>
+#include <cmath>
+
+class GraphObjectRegistry;
+
+static const double VISIBLE_MIN_X = -2.39;
+static const double VISIBLE_MAX_X = 2.39;
+static const double VISIBLE_MIN_Y = -2.1;
+static const double VISIBLE_MAX_Y = 1.9;
+static const double VISIBLE_MIN_Z = -20;
+// static const double VISIBLE_MAX_Z = -6;
+
+static const int WINDOW_WIDTH = 768; //1024;
+static const int WINDOW_HEIGHT = 768;
+
+static const double PERSPECTIVE_FOVY = 45.0;
+static const int PERSPECTIVE_NEAR_PLANE = 4;
+static const int PERSPECTIVE_FAR_PLANE	= 22;
+
+  // Something that draws the game's sprites.  Sprites are loaded once, as
+  // an atlas, then each frame they are queued and flushed in back-to-front
+  // order; a flush must draw everything queued since the last one over
+  // what was drawn before.
+
+class Renderer
+{
+  public:
+	virtual ~Renderer()
+	{
+	}
+
+	  // Take the sprites from atlas, which need not outlive the call
+	virtual bool loadAtlas(const AtlasView& atlas) = 0;
+
+	virtual int getNumFrames(int imageID) const = 0;
+
+	virtual bool queueSprite(int imageID, int frame, double x, double y, int angleDegrees, double size) = 0;
+	virtual void flushSprites() = 0;
+
+  protected:
+	  // Object directions are whole degrees, so sines and cosines come from a
+	  // table built once rather than being computed for every corner drawn.
+	struct RotationTable
+	{
+		double sine[360];
+		double cosine[360];
+
+		RotationTable()
+		{
+			const double PI = 4 * atan(1.0);
+			for (int d = 0; d < 360; d++)
+			{
+				double theta = (d / 360.0) * (2 * PI);
+				sine[d] = sin(theta);
+				cosine[d] = cos(theta);
+			}
+		}
+	};
+
+	  // Rotate (x, y) about the origin
+	static void rotate(double x, double y, int degrees, double& xout, double& yout)
+	{
+		static const RotationTable table;
+		degrees %= 360;
+		if (degrees < 0)
+			degrees += 360;
+		xout = x * table.cosine[degrees] - y * table.sine[degrees];
+		yout = y * table.cosine[degrees] + x * table.sine[degrees];
+	}
+
+	  // Where, in the OpenGL view, a point in the playfield appears
+	static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz)
+	{
+		x /= VIEW_WIDTH;
+		y /= VIEW_HEIGHT;
+		gx = 2 * VISIBLE_MIN_X + .3 + x * 2 * (VISIBLE_MAX_X - VISIBLE_MIN_X);
+		gy = 2 * VISIBLE_MIN_Y +      y * 2 * (VISIBLE_MAX_Y - VISIBLE_MIN_Y);
+		gz = .6 * VISIBLE_MIN_Z;
+	}
+};
+
+  // Load every image the game uses from assetDir's TGA files and pack them
+bool buildGameSpriteAtlas(std::string assetDir, SpriteAtlas& atlas);
+
+  // Stamp the TGA files in assetDir that the game's sprites come from; an
+  // asset pack records these so that one older than its TGAs is not used
+bool stampGameSpriteSources(std::string assetDir, std::vector<AssetPack::SourceStamp>& stamps);
+
+  // Load every image the game uses into renderer, from assetDir's asset
+  // pack if it has an up-to-date, complete one, or else from its TGA files
+bool loadGameSprites(Renderer& renderer, std::string assetDir);
+
+  // Draw every GraphObject (and SpriteBatch) in objects alpha of the way
+  // through the last tick, back to front
+void drawGameSprites(Renderer& renderer, const GraphObjectRegistry& objects, double alpha);
+
+#endif // RENDERER_H_
@@ -0,0 +1,248 @@
+#include "Replay.h"
+#include "GameWorld.h"
+#include <cstring>
+#include <iterator>
+using namespace std;
+
+static const char REPLAY_MAGIC[4] = { 'N', 'B', 'R', 'P' };
+static const unsigned char REPLAY_VERSION = 1;
+
+ReplayRecorder::ReplayRecorder()
+ : m_inner(nullptr), m_checksumInterval(DEFAULT_CHECKSUM_INTERVAL),
+   m_tick(0), m_previousKeyTick(0)
+{
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+	finish();
+}
+
+bool ReplayRecorder::start(string filename, WorldController* inner, uint64_t seed,
+						   unsigned int checksumInterval)
+{
+	m_file.open(filename, ios::out | ios::binary | ios::trunc);
+	if (!m_file)
+		return false;
+	m_inner = inner;
+	m_checksumInterval = (checksumInterval == 0 ? 1 : checksumInterval);
+	m_tick = 0;
+	m_previousKeyTick = 0;
+
+	m_file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+	m_file.put(static_cast<char>(REPLAY_VERSION));
+	writeU64(seed);
+	writeVarint(m_checksumInterval);
+	return true;
+}
+
+void ReplayRecorder::finish()
+{
+	if (!m_file.is_open())
+		return;
+	m_file.put('E');
+	writeVarint(m_tick);
+	m_file.close();
+}
+
+void ReplayRecorder::tickDone(GameWorld& gw)
+{
+	if (m_file.is_open()  &&  (m_tick + 1) % m_checksumInterval == 0)
+	{
+		m_file.put('C');
+		writeVarint(m_tick);
+		writeU64(gw.checksum());
+	}
+	m_tick++;
+}
+
+bool ReplayRecorder::getLastKey(int& value)
+{
+	if (!m_inner->getLastKey(value))
+		return false;
+	if (m_file.is_open())
+	{
+		m_file.put('K');
+		writeVarint(m_tick - m_previousKeyTick);
+		writeVarint(static_cast<unsigned int>(value));
+		m_previousKeyTick = m_tick;
+	}
+	return true;
+}
+
+void ReplayRecorder::playSound(int soundID)
+{
+	m_inner->playSound(soundID);
+}
+
+void ReplayRecorder::setGameStatText(const string& text)
+{
+	m_inner->setGameStatText(text);
+}
+
+void ReplayRecorder::quitGame()
+{
+	m_inner->quitGame();
+}
+
+void ReplayRecorder::writeVarint(uint64_t value)
+{
+	do
+	{
+		unsigned char byte = value & 0x7f;
+		value >>= 7;
+		if (value != 0)
+			byte |= 0x80;
+		m_file.put(static_cast<char>(byte));
+	} while (value != 0);
+}
+
+void ReplayRecorder::writeU64(uint64_t value)
+{
+	for (int k = 0; k < 8; k++)
+		m_file.put(static_cast<char>((value >> (8 * k)) & 0xff));
+}
+
+  // Reading is done from an in-memory copy of the file
+
+class ReplayReader
+{
+  public:
+	ReplayReader(const vector<char>& data)
+	 : m_data(data), m_pos(0), m_ok(true)
+	{
+	}
+
+	bool ok() const
+	{
+		return m_ok;
+	}
+
+	bool atEnd() const
+	{
+		return m_pos >= m_data.size();
+	}
+
+	unsigned char byte()
+	{
+		if (atEnd())
+		{
+			m_ok = false;
+			return 0;
+		}
+		return static_cast<unsigned char>(m_data[m_pos++]);
+	}
+
+	uint64_t varint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			unsigned char b = byte();
+			value |= static_cast<uint64_t>(b & 0x7f) << shift;
+			if ((b & 0x80) == 0)
+				return value;
+		}
+		m_ok = false;
+		return value;
+	}
+
+	uint64_t u64()
+	{
+		uint64_t value = 0;
+		for (int k = 0; k < 8; k++)
+			value |= static_cast<uint64_t>(byte()) << (8 * k);
+		return value;
+	}
+
+  private:
+	const vector<char>& m_data;
+	size_t m_pos;
+	bool m_ok;
+};
+
+bool Replay::load(string filename)
+{
+	ifstream ifs(filename, ios::in | ios::binary);
+	if (!ifs)
+		return false;
+	vector<char> data((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+
+	if (data.size() < sizeof(REPLAY_MAGIC) + 1  ||
+		memcmp(data.data(), REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0  ||
+		data[sizeof(REPLAY_MAGIC)] != REPLAY_VERSION)
+		return false;
+
+	ReplayReader in(data);
+	for (size_t k = 0; k <= sizeof(REPLAY_MAGIC); k++)
+		in.byte();
+	m_seed = in.u64();
+	in.varint();	// checksum interval; the checksums carry their own ticks
+	m_keys.clear();
+	m_checksums.clear();
+	m_numTicks = 0;
+
+	unsigned long keyTick = 0;
+	bool ended = false;
+	while (!ended  &&  in.ok()  &&  !in.atEnd())
+	{
+		switch (in.byte())
+		{
+			case 'K':
+			{
+				keyTick += static_cast<unsigned long>(in.varint());
+				KeyEvent e = { keyTick, static_cast<int>(in.varint()) };
+				m_keys.push_back(e);
+				break;
+			}
+			case 'C':
+			{
+				Checksum c;
+				c.tick = static_cast<unsigned long>(in.varint());
+				c.value = in.u64();
+				m_checksums.push_back(c);
+				break;
+			}
+			case 'E':
+				m_numTicks = static_cast<unsigned long>(in.varint());
+				ended = true;
+				break;
+			default:
+				return false;
+		}
+	}
+	return ended  &&  in.ok();
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay)
+ : m_replay(replay), m_nextKey(0), m_nextChecksum(0), m_tick(0),
+   m_diverged(false), m_divergentTick(0), m_numVerified(0)
+{
+}
+
+int ReplayPlayer::keyForTick(unsigned long tick)
+{
+	const vector<Replay::KeyEvent>& keys = m_replay.getKeys();
+	while (m_nextKey < keys.size()  &&  keys[m_nextKey].tick < tick)
+		m_nextKey++;
+	if (m_nextKey < keys.size()  &&  keys[m_nextKey].tick == tick)
+		return keys[m_nextKey++].key;
+	return INVALID_KEY;
+}
+
+void ReplayPlayer::tickDone(GameWorld& gw)
+{
+	const vector<Replay::Checksum>& checksums = m_replay.getChecksums();
+	if (m_nextChecksum < checksums.size()  &&  checksums[m_nextChecksum].tick == m_tick)
+	{
+		if (gw.checksum() == checksums[m_nextChecksum].value)
+			m_numVerified++;
+		else if (!m_diverged)
+		{
+			m_diverged = true;
+			m_divergentTick = m_tick;
+		}
+		m_nextChecksum++;
+	}
+	m_tick++;
+}
@@ -0,0 +1,140 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "WorldController.h"
+#include "HeadlessController.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+  // Replay file format (all integers little-endian; "varint" is LEB128):
+  //
+  //   "NBRP"  version:u8  seed:u64  checksumInterval:varint
+  //   then records, each starting with a tag byte:
+  //     'K' ticksSincePreviousKey:varint  key:varint   a key the world read
+  //     'C' tick:varint  checksum:u64                  world state after tick
+  //     'E' numTicks:varint                            end of the session
+  //
+  // Ticks count calls to GameWorld::move() from the start of the session,
+  // across lost lives and levels, starting at 0.
+
+const unsigned int DEFAULT_CHECKSUM_INTERVAL = 60;
+
+  // Sits between a world and its real controller, writing every key the
+  // world reads, plus a checksum every so many ticks, to a replay file.
+
+class ReplayRecorder : public WorldController, public TickListener
+{
+  public:
+	ReplayRecorder();
+	~ReplayRecorder();
+
+	bool start(std::string filename, WorldController* inner, std::uint64_t seed,
+			   unsigned int checksumInterval = DEFAULT_CHECKSUM_INTERVAL);
+	void finish();
+
+	bool isRecording() const
+	{
+		return m_file.is_open();
+	}
+
+	virtual void tickDone(GameWorld& gw);
+
+	virtual bool getLastKey(int& value);
+	virtual void playSound(int soundID);
+	virtual void setGameStatText(const std::string& text);
+	virtual void quitGame();
+
+  private:
+	std::ofstream	 m_file;
+	WorldController* m_inner;
+	unsigned int	 m_checksumInterval;
+	unsigned long	 m_tick;
+	unsigned long	 m_previousKeyTick;
+
+	void writeVarint(std::uint64_t value);
+	void writeU64(std::uint64_t value);
+};
+
+class Replay
+{
+  public:
+	bool load(std::string filename);
+
+	std::uint64_t getSeed() const
+	{
+		return m_seed;
+	}
+
+	unsigned long getNumTicks() const
+	{
+		return m_numTicks;
+	}
+
+	struct KeyEvent
+	{
+		unsigned long tick;
+		int key;
+	};
+
+	struct Checksum
+	{
+		unsigned long tick;
+		std::uint64_t value;
+	};
+
+	const std::vector<KeyEvent>& getKeys() const
+	{
+		return m_keys;
+	}
+
+	const std::vector<Checksum>& getChecksums() const
+	{
+		return m_checksums;
+	}
+
+  private:
+	std::uint64_t		  m_seed;
+	unsigned long		  m_numTicks;
+	std::vector<KeyEvent> m_keys;
+	std::vector<Checksum> m_checksums;
+};
+
+  // Feeds a replay's keys to a HeadlessController and checks the world's
+  // checksum against the recorded ones as the ticks go by.
+
+class ReplayPlayer : public KeySource, public TickListener
+{
+  public:
+	ReplayPlayer(const Replay& replay);
+
+	virtual int keyForTick(unsigned long tick);
+	virtual void tickDone(GameWorld& gw);
+
+	bool hasDiverged() const
+	{
+		return m_diverged;
+	}
+
+	unsigned long getDivergentTick() const
+	{
+		return m_divergentTick;
+	}
+
+	unsigned long getNumVerified() const
+	{
+		return m_numVerified;
+	}
+
+  private:
+	const Replay& m_replay;
+	std::size_t	  m_nextKey;
+	std::size_t	  m_nextChecksum;
+	unsigned long m_tick;
+	bool		  m_diverged;
+	unsigned long m_divergentTick;
+	unsigned long m_numVerified;
+};
+
+#endif // REPLAY_H_
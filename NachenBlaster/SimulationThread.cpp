@@ -0,0 +1,180 @@
+#include "SimulationThread.h"
+#include "GameWorld.h"
+#include "GraphObject.h"
+using namespace std;
+
+SimulationThread::SimulationThread(WorldFactory createWorld, string assetDir, WorldController& sound)
+ : m_sound(sound), m_world(nullptr), m_listener(nullptr), m_tick(0),
+   m_key(INVALID_KEY), m_quit(false), m_exiting(false), m_hasStopped(false),
+   m_stoppedStatus(GWSTATUS_CONTINUE_GAME), m_opResult(0), m_opDone(false),
+   m_playing(false), m_tickInterval(0), m_interpolate(false)
+{
+	m_thread = thread(&SimulationThread::threadMain, this, createWorld, assetDir);
+}
+
+SimulationThread::~SimulationThread()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_exiting = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+}
+
+int SimulationThread::call(function<int(GameWorld&)> op)
+{
+	unique_lock<mutex> lock(m_mutex);
+	m_op = op;
+	m_opDone = false;
+	m_cv.notify_all();
+	m_cv.wait(lock, [this] { return m_opDone; });
+	return m_opResult;
+}
+
+void SimulationThread::play(double tickInterval, bool interpolate)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_tickInterval = tickInterval;
+		m_interpolate = interpolate;
+		m_playing = true;
+	}
+	m_cv.notify_all();
+}
+
+bool SimulationThread::stopped(int& status)
+{
+	if (!m_hasStopped.exchange(false, memory_order_acquire))
+		return false;
+	status = m_stoppedStatus;
+	return true;
+}
+
+bool SimulationThread::getLastKey(int& value)
+{
+	int key = m_key.exchange(INVALID_KEY);
+	if (key == INVALID_KEY)
+		return false;
+	value = key;
+	return true;
+}
+
+void SimulationThread::playSound(int soundID)
+{
+	m_sound.playSound(soundID);
+}
+
+void SimulationThread::setGameStatText(const string& text)
+{
+	m_statText = text;
+}
+
+void SimulationThread::quitGame()
+{
+	m_quit = true;
+}
+
+void SimulationThread::threadMain(WorldFactory createWorld, string assetDir)
+{
+	m_world = createWorld(assetDir);
+	m_world->setController(this);
+
+	unique_lock<mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_cv.wait(lock, [this] { return m_exiting  ||  m_op  ||  m_playing; });
+		if (m_exiting)
+			break;
+		if (m_op)
+		{
+			m_opResult = m_op(*m_world);
+			m_op = nullptr;
+			m_opDone = true;
+			m_cv.notify_all();
+		}
+		else
+		{
+			lock.unlock();
+			int status = playLoop();
+			lock.lock();
+			m_playing = false;
+			m_stoppedStatus = status;
+			m_hasStopped.store(true, memory_order_release);
+		}
+	}
+	lock.unlock();
+	delete m_world;
+}
+
+  // Tick at a fixed rate, never waiting on the render thread.  If a tick
+  // runs long, the next ones run back to back until the world has caught
+  // up, but the world never tries to make up more than a few ticks.
+
+int SimulationThread::playLoop()
+{
+	typedef chrono::steady_clock Clock;
+	const Clock::duration interval = chrono::duration_cast<Clock::duration>(
+										chrono::duration<double>(m_tickInterval));
+	const int MAX_CATCH_UP_TICKS = 5;
+
+	publishSnapshot();	// the world as init() left it
+	Clock::time_point next = Clock::now() + interval;
+	while (!m_exiting  &&  !m_quit)
+	{
+		this_thread::sleep_until(next);
+		if (m_interpolate)
+			m_world->getGraphObjects().startTick();
+		int status = m_world->move();
+		m_world->drainEvents();
+		m_tick++;
+		if (m_listener != nullptr)
+			m_listener->tickDone(*m_world);
+		publishSnapshot();
+		if (status != GWSTATUS_CONTINUE_GAME)
+			return status;
+
+		next += interval;
+		Clock::time_point now = Clock::now();
+		if (now - next > MAX_CATCH_UP_TICKS * interval)
+			next = now;
+	}
+	return GWSTATUS_CONTINUE_GAME;
+}
+
+void SimulationThread::publishSnapshot()
+{
+	RenderSnapshot& snap = m_snapshots.back();
+	snap.sprites.clear();
+	size_t depthStart = 0;
+	const GraphObjectRegistry& objects = m_world->getGraphObjects();
+	objects.drawAllObjects(
+		[&snap](int imageID, int animationNumber, double x, double y, int dir, double size)
+		{
+			SnapshotSprite s = { imageID, animationNumber, x, y, x, y, dir, size, 0 };
+			snap.sprites.push_back(s);
+		},
+		[&snap, &depthStart](int depth)
+		{
+			for ( ; depthStart < snap.sprites.size(); depthStart++)
+				snap.sprites[depthStart].depth = depth;
+		});
+	if (m_interpolate)
+	{
+		  // the same objects in the same order, at where they were
+		size_t k = 0;
+		objects.drawAllObjects(
+			[&snap, &k](int, int, double x, double y, int, double)
+			{
+				snap.sprites[k].prevX = x;
+				snap.sprites[k].prevY = y;
+				k++;
+			},
+			[](int) {},
+			0.0);
+	}
+	snap.statText = m_statText;
+	snap.tick = m_tick;
+	snap.tickTime = chrono::steady_clock::now();
+	m_snapshots.publish();
+}
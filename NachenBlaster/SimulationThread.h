@@ -0,0 +1,134 @@
+#ifndef SIMULATIONTHREAD_H_
+#define SIMULATIONTHREAD_H_
+
+#include "WorldController.h"
+#include "HeadlessController.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GameWorld;
+
+  // Everything needed to draw one tick of the game, copied out of the world
+  // so it can be drawn on another thread while the world moves on.
+
+struct SnapshotSprite
+{
+	int	   imageID;
+	int	   animationNumber;
+	double x;
+	double y;
+	double prevX;	// where the sprite was before the tick
+	double prevY;
+	int	   direction;
+	double size;
+	int	   depth;
+};
+
+struct RenderSnapshot
+{
+	std::vector<SnapshotSprite> sprites;	// back to front
+	std::string					statText;
+	unsigned long				tick;
+	std::chrono::steady_clock::time_point tickTime;
+};
+
+  // Owns a GameWorld and runs it on a thread of its own.  The world is
+  // created, moved, cleaned up and destroyed only on that thread, so
+  // nothing in it (its actors, their registry and pools) needs a lock.
+  //
+  // call() runs an operation on the world and waits for it.  play() sets
+  // the world moving at a fixed tick rate until move() returns something
+  // other than GWSTATUS_CONTINUE_GAME; after every tick it publishes a
+  // RenderSnapshot that the render thread picks up with latestSnapshot().
+  // The world's sounds go to the given controller from this thread, its
+  // key presses come from pressKey(), and its stat text goes into the
+  // snapshots.
+
+class SimulationThread : public WorldController
+{
+  public:
+	typedef GameWorld* (*WorldFactory)(std::string assetDir);
+
+	SimulationThread(WorldFactory createWorld, std::string assetDir, WorldController& sound);
+	~SimulationThread();
+
+	  // Run op on the simulation thread and return its result.  Not while playing.
+	int call(std::function<int(GameWorld&)> op);
+
+	  // Start moving the world every tickInterval seconds.  With interpolate,
+	  // snapshots also record where each sprite was before its tick.
+	void play(double tickInterval, bool interpolate);
+
+	  // If the world has stopped playing since the last call, set status to
+	  // the move() result that stopped it and return true
+	bool stopped(int& status);
+
+	  // Render thread only
+	const RenderSnapshot& latestSnapshot()
+	{
+		return m_snapshots.front();
+	}
+
+	void pressKey(int key)
+	{
+		m_key.store(key);
+	}
+
+	bool quitRequested() const
+	{
+		return m_quit.load();
+	}
+
+	  // Told about every tick, on the simulation thread; set it from call()
+	void setTickListener(TickListener* listener)
+	{
+		m_listener = listener;
+	}
+
+	  // WorldController, called by the world on the simulation thread
+	virtual bool getLastKey(int& value);
+	virtual void playSound(int soundID);
+	virtual void setGameStatText(const std::string& text);
+	virtual void quitGame();
+
+  private:
+	WorldController&		m_sound;
+	GameWorld*				m_world;
+	TickListener*			m_listener;
+	std::string				m_statText;
+	unsigned long			m_tick;
+	TripleBuffer<RenderSnapshot> m_snapshots;
+	std::atomic<int>		m_key;
+	std::atomic<bool>		m_quit;
+	std::atomic<bool>		m_exiting;
+	std::atomic<bool>		m_hasStopped;
+	int						m_stoppedStatus;
+
+	  // Requests from the render thread, guarded by m_mutex
+	std::mutex				m_mutex;
+	std::condition_variable m_cv;
+	std::function<int(GameWorld&)> m_op;
+	int						m_opResult;
+	bool					m_opDone;
+	bool					m_playing;
+	double					m_tickInterval;
+	bool					m_interpolate;
+
+	std::thread				m_thread;
+
+	void threadMain(WorldFactory createWorld, std::string assetDir);
+	int playLoop();
+	void publishSnapshot();
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+};
+
+#endif // SIMULATIONTHREAD_H_
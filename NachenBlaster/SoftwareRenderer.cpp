@@ -0,0 +1,307 @@
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NB_SOFTWARE_SSE2
+#include <emmintrin.h>
+#endif
+
+  // Filtering weights have 7 fractional bits, so the product of two fits
+  // in the 16-bit lanes of an SSE2 multiply-add.
+static const int WEIGHT_BITS = 7;
+static const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+static const int FIXED_BITS = 16;	// texel positions are 16.16 fixed point
+
+  // The color of the sprite at a point between four texels: p0 points at
+  // the lower left of them and p1 at the upper left, and fx and fy say how
+  // far the point is from there towards the other two.
+
+static inline uint32_t sampleBilinear(const unsigned char* p0, const unsigned char* p1, int fx, int fy)
+{
+	int w00 = (WEIGHT_ONE - fx) * (WEIGHT_ONE - fy);
+	int w10 = fx * (WEIGHT_ONE - fy);
+	int w01 = (WEIGHT_ONE - fx) * fy;
+	int w11 = fx * fy;
+	const int SHIFT = 2 * WEIGHT_BITS;
+	uint32_t result;
+#ifdef NB_SOFTWARE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lower = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p0)), zero);
+	__m128i upper = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p1)), zero);
+	  // pair each channel of the left texel with the same channel of the right
+	lower = _mm_unpacklo_epi16(lower, _mm_srli_si128(lower, 8));
+	upper = _mm_unpacklo_epi16(upper, _mm_srli_si128(upper, 8));
+	__m128i sum = _mm_add_epi32(_mm_madd_epi16(lower, _mm_set1_epi32((w10 << 16) | w00)),
+								_mm_madd_epi16(upper, _mm_set1_epi32((w11 << 16) | w01)));
+	sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (SHIFT - 1))), SHIFT);
+	sum = _mm_packs_epi32(sum, sum);
+	int packed = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+	memcpy(&result, &packed, 4);
+#else
+	unsigned char channels[4];
+	for (int c = 0; c < 4; c++)
+		channels[c] = static_cast<unsigned char>((p0[c] * w00 + p0[4+c] * w10 + p1[c] * w01 + p1[4+c] * w11
+												  + (1 << (SHIFT - 1))) >> SHIFT);
+	memcpy(&result, channels, 4);
+#endif
+	return result;
+}
+
+  // dst = src * alpha + dst * (1 - alpha), rounded exactly, for each color
+  // channel of n (at most 4) pixels; the frame stays opaque.
+
+static inline void blendPixels(unsigned char* dst, const uint32_t* src, int n)
+{
+#ifdef NB_SOFTWARE_SSE2
+	if (n == 4)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i max = _mm_set1_epi16(255);
+		const __m128i half = _mm_set1_epi16(128);
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+		__m128i halves[2];
+		for (int k = 0; k < 2; k++)
+		{
+			__m128i sk = (k == 0 ? _mm_unpacklo_epi8(s, zero) : _mm_unpackhi_epi8(s, zero));
+			__m128i dk = (k == 0 ? _mm_unpacklo_epi8(d, zero) : _mm_unpackhi_epi8(d, zero));
+			__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sk, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+			__m128i x = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sk, a),
+													_mm_mullo_epi16(dk, _mm_sub_epi16(max, a))), half);
+			halves[k] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+		}
+		const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+						 _mm_or_si128(_mm_packus_epi16(halves[0], halves[1]), opaque));
+		return;
+	}
+#endif
+	for (int k = 0; k < n; k++, dst += 4)
+	{
+		unsigned char s[4];
+		memcpy(s, &src[k], 4);
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int x = s[c] * s[3] + dst[c] * (255 - s[3]) + 128;
+			dst[c] = static_cast<unsigned char>((x + (x >> 8)) >> 8);
+		}
+		dst[3] = 255;
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height)
+{
+	m_frame.width = width;
+	m_frame.height = height;
+	m_frame.pixels.resize(static_cast<size_t>(width) * height * 4);
+	clear();
+
+	  // gluPerspective, as set up by GameController::reshape, shows this much
+	  // of the plane the sprites are drawn in
+	double gx, gy, gz;
+	convertToGlutCoords(0, 0, gx, gy, gz);
+	const double PI = 4 * atan(1.0);
+	double halfHeight = -gz * tan(PERSPECTIVE_FOVY / 2 * PI / 180);
+	m_pixelsPerUnit = height / (2 * halfHeight);
+}
+
+  // Each sprite is copied out of the atlas, leaving a border around it.
+
+bool SoftwareRenderer::loadAtlas(const AtlasView& atlas)
+{
+	if (atlas.levels.empty())
+		return false;
+	const AtlasLevel& full = atlas.levels[0];
+
+	m_sprites.clear();
+	m_frameCountPerSprite.clear();
+	for (size_t k = 0; k < atlas.numSprites; k++)
+	{
+		const AtlasSprite& s = atlas.sprites[k];
+		int spriteID = getSpriteID(s.imageID, s.frameNum);
+		if (INVALID_SPRITE_ID == spriteID)
+			return false;
+
+		if (static_cast<size_t>(spriteID) >= m_sprites.size())
+			m_sprites.resize(spriteID + 1);
+		m_sprites[spriteID].valid = true;
+		RgbaImage& sprite = m_sprites[spriteID].image;
+		sprite.width = s.width + 2;
+		sprite.height = s.height + 2;
+		sprite.pixels.assign(static_cast<size_t>(sprite.width) * sprite.height * 4, 0);
+		for (unsigned int y = 0; y < s.height; y++)
+			memcpy(sprite.row(y + 1) + 4, full.pixels + ((static_cast<size_t>(s.y) + y) * full.width + s.x) * 4, s.width * 4);
+
+		if (static_cast<size_t>(s.imageID) >= m_frameCountPerSprite.size())
+			m_frameCountPerSprite.resize(s.imageID + 1, 0);
+		m_frameCountPerSprite[s.imageID]++;
+	}
+	return !m_sprites.empty();
+}
+
+int SoftwareRenderer::getNumFrames(int imageID) const
+{
+	if (imageID < 0  ||  static_cast<size_t>(imageID) >= m_frameCountPerSprite.size())
+		return 0;
+
+	return m_frameCountPerSprite[imageID];
+}
+
+  // Sprites are blended into the frame as soon as they are queued, which
+  // draws them in the same order a flush would.
+
+bool SoftwareRenderer::queueSprite(int imageID, int frame, double x, double y, int angleDegrees, double size)
+{
+	int spriteID = getSpriteID(imageID, frame);
+	if (INVALID_SPRITE_ID == spriteID)
+		return false;
+
+	if (static_cast<size_t>(spriteID) >= m_sprites.size()  ||  !m_sprites[spriteID].valid)
+		return false;
+
+	double gx, gy, gz;
+	convertToGlutCoords(x, y, gx, gy, gz);
+	drawSprite(m_sprites[spriteID].image, m_frame.width / 2.0 + gx * m_pixelsPerUnit, m_frame.height / 2.0 + gy * m_pixelsPerUnit,
+			   SPRITE_WIDTH_GL * size * m_pixelsPerUnit, SPRITE_HEIGHT_GL * size * m_pixelsPerUnit, angleDegrees);
+	return true;
+}
+
+void SoftwareRenderer::flushSprites()
+{
+}
+
+void SoftwareRenderer::clear()
+{
+	if (m_frame.pixels.empty())
+		return;
+	unsigned char* first = m_frame.row(0);
+	for (unsigned int x = 0; x < m_frame.width; x++)
+	{
+		first[4*x] = first[4*x+1] = first[4*x+2] = 0;
+		first[4*x+3] = 255;
+	}
+	for (unsigned int y = 1; y < m_frame.height; y++)
+		memcpy(m_frame.row(y), first, m_frame.width * 4);
+}
+
+int SoftwareRenderer::getSpriteID(int imageID, int frame) const
+{
+	if (imageID < 0 || imageID >= MAX_IMAGES || frame < 0 || frame >= MAX_FRAMES_PER_SPRITE)
+		return INVALID_SPRITE_ID;
+
+	return imageID * MAX_FRAMES_PER_SPRITE + frame;
+}
+
+  // Draw the sprite as a width by height rectangle centered at (cx, cy) in
+  // the frame, rotated angleDegrees counterclockwise.  Each frame pixel in
+  // the rectangle's bounds is mapped back into the sprite, and the four
+  // texels around that point are filtered together.
+
+void SoftwareRenderer::drawSprite(const RgbaImage& sprite, double cx, double cy, double width, double height, int angleDegrees)
+{
+	if (width <= 0  ||  height <= 0)
+		return;
+
+	double minX = cx, maxX = cx, minY = cy, maxY = cy;
+	static const double corners[4][2] = { { -.5, -.5 }, { .5, -.5 }, { .5, .5 }, { -.5, .5 } };
+	for (int k = 0; k < 4; k++)
+	{
+		double rx, ry;
+		rotate(corners[k][0] * width, corners[k][1] * height, angleDegrees, rx, ry);
+		minX = min(minX, cx + rx);
+		maxX = max(maxX, cx + rx);
+		minY = min(minY, cy + ry);
+		maxY = max(maxY, cy + ry);
+	}
+	int x0 = max(0, static_cast<int>(floor(minX)));
+	int x1 = min(static_cast<int>(m_frame.width), static_cast<int>(ceil(maxX)));
+	int y0 = max(0, static_cast<int>(floor(minY)));
+	int y1 = min(static_cast<int>(m_frame.height), static_cast<int>(ceil(maxY)));
+	if (x0 >= x1  ||  y0 >= y1)
+		return;
+
+	  // Rotating back by the sprite's angle and scaling gives the position in
+	  // the sprite, in texels from the lower left corner of its border.
+	unsigned int imageWidth = sprite.width - 2;
+	unsigned int imageHeight = sprite.height - 2;
+	double cosine, sine;
+	rotate(1, 0, angleDegrees, cosine, sine);
+	double uPerPixel = imageWidth / width;
+	double vPerPixel = imageHeight / height;
+	const double ONE = 1 << FIXED_BITS;
+	long duFixed = lround(cosine * uPerPixel * ONE);
+	long dvFixed = lround(-sine * vPerPixel * ONE);
+
+	uint32_t samples[4];
+	for (int y = y0; y < y1; y++)
+	{
+		double dx = x0 + .5 - cx;
+		double dy = y + .5 - cy;
+		long uFixed = lround(((dx * cosine + dy * sine) * uPerPixel + imageWidth / 2.0 + .5) * ONE);
+		long vFixed = lround(((dy * cosine - dx * sine) * vPerPixel + imageHeight / 2.0 + .5) * ONE);
+		unsigned char* dst = m_frame.row(y) + x0 * 4;
+		for (int x = x0; x < x1; x += 4, dst += 16)
+		{
+			int n = min(4, x1 - x);
+			bool any = false;
+			for (int k = 0; k < n; k++, uFixed += duFixed, vFixed += dvFixed)
+			{
+				samples[k] = 0;
+				if (uFixed < 0  ||  vFixed < 0)
+					continue;
+				unsigned long u = uFixed >> FIXED_BITS;
+				unsigned long v = vFixed >> FIXED_BITS;
+				if (u > imageWidth  ||  v > imageHeight)
+					continue;
+				const unsigned char* p0 = sprite.row(v) + u * 4;
+				int fx = (uFixed >> (FIXED_BITS - WEIGHT_BITS)) & (WEIGHT_ONE - 1);
+				int fy = (vFixed >> (FIXED_BITS - WEIGHT_BITS)) & (WEIGHT_ONE - 1);
+				samples[k] = sampleBilinear(p0, p0 + sprite.width * 4, fx, fy);
+				any = any  ||  samples[k] != 0;
+			}
+			if (any)
+				blendPixels(dst, samples, n);
+		}
+	}
+}
+
+unsigned long countDifferingPixels(const RgbaImage& a, const RgbaImage& b, int tolerance)
+{
+	if (a.width != b.width  ||  a.height != b.height)
+		return max(static_cast<unsigned long>(a.width) * a.height, static_cast<unsigned long>(b.width) * b.height);
+
+	unsigned long count = 0;
+	size_t k = 0;
+#ifdef NB_SOFTWARE_SSE2
+	  // four pixels at a time: a channel differs too much if its absolute
+	  // difference is still nonzero after subtracting the tolerance
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i allowed = _mm_set1_epi8(static_cast<char>(min(max(tolerance, 0), 255)));
+	for ( ; k + 16 <= a.pixels.size(); k += 16)
+	{
+		__m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a.pixels[k]));
+		__m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b.pixels[k]));
+		__m128i diff = _mm_or_si128(_mm_subs_epu8(pa, pb), _mm_subs_epu8(pb, pa));
+		__m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, allowed), zero);
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(same));
+		count += 4 - ((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1));
+	}
+#endif
+	for ( ; k < a.pixels.size(); k += 4)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			if (abs(a.pixels[k+c] - b.pixels[k+c]) > tolerance)
+			{
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
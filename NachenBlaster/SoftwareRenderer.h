@@ -0,0 +1,61 @@
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+#include "Renderer.h"
+#include "TgaImage.h"
+#include <string>
+#include <vector>
+
+  // Draws sprites on the CPU into an RGBA frame in memory, laid out as the
+  // game window would show them, so frames can be rendered with no display
+  // or GPU.  Sprites are rotated, scaled, bilinear filtered, and alpha
+  // blended over the frame as they are queued.  Only the sprites are drawn,
+  // not the text above the playfield.
+
+class SoftwareRenderer : public Renderer
+{
+  public:
+	SoftwareRenderer(unsigned int width = WINDOW_WIDTH, unsigned int height = WINDOW_HEIGHT);
+
+	virtual bool loadAtlas(const AtlasView& atlas);
+	virtual int getNumFrames(int imageID) const;
+	virtual bool queueSprite(int imageID, int frame, double x, double y, int angleDegrees, double size);
+	virtual void flushSprites();
+
+	  // Fill the frame with opaque black
+	void clear();
+
+	const RgbaImage& getFrame() const
+	{
+		return m_frame;
+	}
+
+  private:
+	static const int INVALID_SPRITE_ID = -1;
+	static const int MAX_IMAGES = 1000;
+	static const int MAX_FRAMES_PER_SPRITE = 100;
+
+	struct LoadedSprite
+	{
+		bool	  valid;
+		RgbaImage image;
+	};
+
+	  // Sprite images are kept with a one-texel transparent border, so that
+	  // filtering at an edge needs no bounds checks.  Both tables are
+	  // indexed directly, by sprite ID and by image ID, and grow to the
+	  // largest one loaded.
+	std::vector<LoadedSprite> m_sprites;
+	std::vector<int>		 m_frameCountPerSprite;
+	RgbaImage				 m_frame;
+	double					 m_pixelsPerUnit;	// frame pixels per OpenGL unit at the sprites' depth
+
+	int getSpriteID(int imageID, int frame) const;
+	void drawSprite(const RgbaImage& sprite, double cx, double cy, double width, double height, int angleDegrees);
+};
+
+  // Count the pixels that differ between two frames by more than tolerance
+  // in any channel; frames of different sizes differ in every pixel.
+unsigned long countDifferingPixels(const RgbaImage& a, const RgbaImage& b, int tolerance);
+
+#endif // SOFTWARERENDERER_H_
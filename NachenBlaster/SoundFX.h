@@ -2,6 +2,7 @@
 #define SOUNDFX_H_
 
 #include <string>
+#include <vector>
 
 #if defined(_MSC_VER)
 
@@ -19,6 +20,19 @@ class SoundFXController
 			m_engine->play2D(soundFile.c_str(), false);
 	}
 
+	  // Return a handle with which the clip can later be played cheaply
+	int registerClip(std::string soundFile)
+	{
+		m_clips.push_back(soundFile);
+		return static_cast<int>(m_clips.size()) - 1;
+	}
+
+	void playClip(int handle)
+	{
+		if (m_engine != nullptr)
+			m_engine->play2D(m_clips[handle].c_str(), false);
+	}
+
 	void abortClip()
 	{
 		if (m_engine != nullptr)
@@ -29,6 +43,7 @@ class SoundFXController
 
   private:
 	irrklang::ISoundEngine* m_engine;
+	std::vector<std::string> m_clips;
 
 	SoundFXController()
 	{
@@ -89,22 +104,70 @@ class SoundFXController
 			kill(pid, SIGINT);
 		pidValid = false;
 	}
+
+	  // Return a handle with which the clip can later be played
+	int registerClip(std::string soundFile)
+	{
+		m_clips.push_back(soundFile);
+		return static_cast<int>(m_clips.size()) - 1;
+	}
+
+	void playClip(int handle)
+	{
+		playClip(m_clips[handle]);
+	}
 	
 	static SoundFXController& getInstance();
 
   private:
 	pid_t pid;
 	bool pidValid;
+	std::vector<std::string> m_clips;
 };
 
-#else  // forget about sound
+#else  // clips are decoded once and mixed in-process
+
+#include "AudioMixer.h"
+
+#define SOUNDFX_HAS_MIXER
 
 class SoundFXController
 {
   public:
-	void playClip(std::string) {}
-	void abortClip() {}
+	void playClip(std::string soundFile)
+	{
+		m_mixer.play(m_mixer.load(soundFile));
+	}
+
+	  // Decode a clip ahead of time and return a handle with which it can
+	  // later be played without a lookup or allocation
+	int registerClip(std::string soundFile)
+	{
+		m_clips.push_back(m_mixer.load(soundFile));
+		return static_cast<int>(m_clips.size()) - 1;
+	}
+
+	void playClip(int handle)
+	{
+		m_mixer.play(m_clips[handle]);
+	}
+
+	void abortClip()
+	{
+		m_mixer.stopAll();
+	}
+
+	  // "null", "aplay", or a .wav file to record the game's sound into
+	void setOutput(std::string output)
+	{
+		m_mixer.setOutput(output);
+	}
+
 	static SoundFXController& getInstance();
+
+  private:
+	AudioMixer m_mixer;
+	std::vector<const AudioClip*> m_clips;
 };
 
 #endif
@@ -0,0 +1,120 @@
+#include "SpriteAtlas.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+bool SpriteAtlas::build(const vector<Source>& sources, unsigned int maxSize)
+{
+	m_sprites.clear();
+	m_levels.clear();
+	if (sources.empty())
+		return false;
+
+	vector<size_t> order;
+	for (size_t k = 0; k < sources.size(); k++)
+		order.push_back(k);
+	stable_sort(order.begin(), order.end(), [&sources](size_t a, size_t b) {
+		return sources[a].image.height > sources[b].image.height;
+	});
+
+	vector<AtlasSprite> placement(sources.size());
+	unsigned int atlasWidth, atlasHeight;
+	for (atlasWidth = 256; ; atlasWidth *= 2)
+	{
+		if (atlasWidth > maxSize)
+			return false;
+		if (packShelves(sources, order, atlasWidth, placement, atlasHeight)  &&  atlasHeight <= atlasWidth)
+			break;
+	}
+
+	RgbaImage atlas;
+	atlas.width = atlasWidth;
+	atlas.height = atlasHeight;
+	atlas.pixels.assign(static_cast<size_t>(atlasWidth) * atlasHeight * 4, 0);
+	for (size_t k = 0; k < sources.size(); k++)
+	{
+		const RgbaImage& image = sources[k].image;
+		const AtlasSprite& p = placement[k];
+		for (unsigned int row = 0; row < image.height; row++)
+			memcpy(atlas.row(p.y + row) + p.x * 4, image.row(row), image.width * 4);
+	}
+	m_sprites = placement;
+
+	m_levels.push_back(atlas);
+	while (m_levels.back().width > 1  ||  m_levels.back().height > 1)
+	{
+		RgbaImage smaller;
+		halve(m_levels.back(), smaller);
+		m_levels.push_back(smaller);
+	}
+	return true;
+}
+
+AtlasView SpriteAtlas::view() const
+{
+	AtlasView v;
+	v.sprites = m_sprites.data();
+	v.numSprites = m_sprites.size();
+	for (const RgbaImage& level : m_levels)
+	{
+		AtlasLevel l = { level.width, level.height, level.pixels.data() };
+		v.levels.push_back(l);
+	}
+	return v;
+}
+
+  // Place the sprites, in the given order, left to right on shelves of
+  // the given width; fail if a sprite is wider than the atlas.
+
+bool SpriteAtlas::packShelves(const vector<Source>& sources, const vector<size_t>& order,
+							  unsigned int atlasWidth, vector<AtlasSprite>& placement,
+							  unsigned int& atlasHeight)
+{
+	unsigned int x = 0, shelfY = 0, shelfHeight = 0;
+	for (size_t k : order)
+	{
+		const RgbaImage& image = sources[k].image;
+		if (image.width > atlasWidth)
+			return false;
+		if (x + image.width > atlasWidth)
+		{
+			shelfY += shelfHeight + ATLAS_GUTTER;
+			x = 0;
+			shelfHeight = 0;
+		}
+		AtlasSprite p = { sources[k].imageID, sources[k].frameNum, x, shelfY, image.width, image.height };
+		placement[k] = p;
+		x += image.width + ATLAS_GUTTER;
+		shelfHeight = max(shelfHeight, image.height);
+	}
+	unsigned int used = shelfY + shelfHeight;
+	for (atlasHeight = 1; atlasHeight < used; atlasHeight *= 2)
+		;
+	return true;
+}
+
+  // The next mip level: each texel is the average of the (up to) four it
+  // covers in the level above, as gluBuild2DMipmaps would make it.
+
+void SpriteAtlas::halve(const RgbaImage& from, RgbaImage& to)
+{
+	to.width = max(1u, from.width / 2);
+	to.height = max(1u, from.height / 2);
+	to.pixels.resize(static_cast<size_t>(to.width) * to.height * 4);
+	unsigned int dx = (from.width > 1 ? 1 : 0);
+	unsigned int dy = (from.height > 1 ? 1 : 0);
+	for (unsigned int y = 0; y < to.height; y++)
+	{
+		const unsigned char* lower = from.row(2 * y * dy);
+		const unsigned char* upper = from.row(2 * y * dy + dy);
+		unsigned char* out = to.row(y);
+		for (unsigned int x = 0; x < to.width; x++)
+		{
+			unsigned int left = 2 * x * dx * 4;
+			unsigned int right = left + dx * 4;
+			for (int c = 0; c < 4; c++)
+				out[4*x+c] = static_cast<unsigned char>((lower[left+c] + lower[right+c] +
+														 upper[left+c] + upper[right+c] + 2) / 4);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef SPRITEATLAS_H_
+#define SPRITEATLAS_H_
+
+#include "TgaImage.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+  // Where one frame of one image sits in an atlas, in texels of its full
+  // size level, from the lower left.
+
+struct AtlasSprite
+{
+	std::int32_t  imageID;
+	std::int32_t  frameNum;
+	std::uint32_t x;
+	std::uint32_t y;
+	std::uint32_t width;
+	std::uint32_t height;
+};
+
+struct AtlasLevel
+{
+	unsigned int width;
+	unsigned int height;
+	const unsigned char* pixels;	// RGBA, bottom row first
+};
+
+  // A read-only look at an atlas, wherever its pixels happen to be kept (in
+  // a SpriteAtlas, or in an AssetPack mapped from a file).  Level 0 is the
+  // full size image; each following level is half the size of the one
+  // before, down to 1 by 1.
+
+struct AtlasView
+{
+	const AtlasSprite*		sprites = nullptr;
+	std::size_t				numSprites = 0;
+	std::vector<AtlasLevel> levels;
+};
+
+  // Every sprite packed into a single power-of-two image, plus its mip
+  // levels, so that a whole frame can be drawn from one texture.
+
+class SpriteAtlas
+{
+  public:
+	struct Source
+	{
+		int		  imageID;
+		int		  frameNum;
+		RgbaImage image;
+	};
+
+	  // Pack the images, placing them on shelves, tallest first, with a
+	  // transparent gutter between them so filtering does not bleed
+	  // neighbors in; fail if they don't fit in maxSize by maxSize.
+	bool build(const std::vector<Source>& sources, unsigned int maxSize = MAX_ATLAS_SIZE);
+
+	AtlasView view() const;
+
+	const std::vector<AtlasSprite>& getSprites() const
+	{
+		return m_sprites;
+	}
+
+	const std::vector<RgbaImage>& getLevels() const
+	{
+		return m_levels;
+	}
+
+	static const unsigned int MAX_ATLAS_SIZE = 4096;
+
+  private:
+	static const unsigned int ATLAS_GUTTER = 4;
+
+	std::vector<AtlasSprite> m_sprites;
+	std::vector<RgbaImage>	 m_levels;
+
+	static bool packShelves(const std::vector<Source>& sources, const std::vector<std::size_t>& order,
+							unsigned int atlasWidth, std::vector<AtlasSprite>& placement,
+							unsigned int& atlasHeight);
+	static void halve(const RgbaImage& from, RgbaImage& to);
+};
+
+#endif // SPRITEATLAS_H_
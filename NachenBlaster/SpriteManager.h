@@ -3,34 +3,26 @@
 
 #include "freeglut.h"
 
-#ifndef GL_BGR
-#define GL_BGR GL_BGR_EXT
-#endif
-
-#ifndef GL_BGRA
-#define GL_BGRA GL_BGRA_EXT
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
 #endif
 
 #include "GameConstants.h"
+#include "Renderer.h"
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <map>
+#include <vector>
+#include <algorithm>
 #include <cmath>
 
-static const double VISIBLE_MIN_X = -2.39;
-static const double VISIBLE_MAX_X = 2.39;
-static const double VISIBLE_MIN_Y = -2.1;
-static const double VISIBLE_MAX_Y = 1.9;
-static const double VISIBLE_MIN_Z = -20;
-// static const double VISIBLE_MAX_Z = -6;
+  // Draws sprites with OpenGL
 
-class SpriteManager
+class SpriteManager : public Renderer
 {
 public:
 
 	SpriteManager()
-	 : m_mipMapped(true)
+	 : m_mipMapped(true), m_atlasTexture(0)
 	{
 	}
 
@@ -39,61 +31,51 @@ public:
 		m_mipMapped = status;
 	}
 
-	bool loadSprite(std::string filename_tga, int imageID, int frameNum)
-	{
-		  // Load Texture Data From TGA File
+	  // Upload the atlas, with its mip levels if mipmapping, as the single
+	  // texture that every sprite is drawn from.
 
-		int spriteID = getSpriteID(imageID, frameNum);
-		if (INVALID_SPRITE_ID == spriteID)
+	virtual bool loadAtlas(const AtlasView& atlas)
+	{
+		if (atlas.levels.empty())
 			return false;
+		const AtlasLevel& full = atlas.levels[0];
 
-		m_frameCountPerSprite[imageID]++;	// keep track of how many frames per sprite we loaded
-
-		std::string line;
-		std::string contents = "";
-		std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-
-		if (!tgaFile)
+		GLint maxTextureSize;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		if (full.width > static_cast<unsigned int>(maxTextureSize)  ||
+			full.height > static_cast<unsigned int>(maxTextureSize))
 			return false;
 
-		char type[3];
-		char info[6];
-
-		  // Read file header info
-		tgaFile.read(type, 3);
-		tgaFile.seekg(12);
-		tgaFile.read(info, 6);
-		unsigned int textureWidth = static_cast<unsigned char>(info[0]) + static_cast<unsigned char>(info[1]) * 256;
-		unsigned int textureHeight = static_cast<unsigned char>(info[2]) + static_cast<unsigned char>(info[3]) * 256;
-		unsigned char byteCount = static_cast<unsigned char>(info[4]) / 8;
-		long imageSize = textureWidth * textureHeight * byteCount;
-		char* imageData = new char[imageSize];
-		tgaFile.seekg(18);
-		  // Read image data
-		tgaFile.read(imageData, imageSize);
-		if (!tgaFile)
+		m_spriteRects.clear();
+		m_frameCountPerSprite.clear();
+		for (std::size_t k = 0; k < atlas.numSprites; k++)
 		{
-			delete [] imageData;
-			return false;
+			const AtlasSprite& sprite = atlas.sprites[k];
+			int spriteID = getSpriteID(sprite.imageID, sprite.frameNum);
+			if (INVALID_SPRITE_ID == spriteID)
+				return false;
+			if (static_cast<std::size_t>(sprite.imageID) >= m_frameCountPerSprite.size())
+				m_frameCountPerSprite.resize(sprite.imageID + 1, 0);
+			m_frameCountPerSprite[sprite.imageID]++;	// keep track of how many frames per sprite we loaded
+
+			if (static_cast<std::size_t>(spriteID) >= m_spriteRects.size())
+				m_spriteRects.resize(spriteID + 1);
+			AtlasRect& rect = m_spriteRects[spriteID];
+			rect.valid = true;
+			rect.s0 = static_cast<GLfloat>(sprite.x) / full.width;
+			rect.t0 = static_cast<GLfloat>(sprite.y) / full.height;
+			rect.s1 = static_cast<GLfloat>(sprite.x + sprite.width) / full.width;
+			rect.t1 = static_cast<GLfloat>(sprite.y + sprite.height) / full.height;
 		}
 
-		  //image type either 2 (color) or 3 (greyscale)
-		if (type[1] != 0 || (type[2] != 2 && type[2] != 3))
-			return false;
-
-		if (byteCount != 3 && byteCount != 4)
-			return false;
-
 		  // Transfer Texture To OpenGL
 
 		glEnable(GL_DEPTH_TEST);
 
-		  // allocate a texture handle
-		GLuint glTextureID;
-		glGenTextures(1, &glTextureID);
-
-		  // bind our new texture
-		glBindTexture(GL_TEXTURE_2D, glTextureID);
+		if (m_atlasTexture != 0)
+			glDeleteTextures(1, &m_atlasTexture);
+		glGenTextures(1, &m_atlasTexture);
+		glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
 
 		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
@@ -110,150 +92,119 @@ public:
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		}
 
-		  // Have the texture wrap both vertically and horizontally.
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
+		  // Sprites must not wrap around into the other side of the atlas.
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_CLAMP_TO_EDGE));
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_CLAMP_TO_EDGE));
 
-		if (m_mipMapped)
+		  // The mip levels come ready made, so each goes straight from where
+		  // it is kept (usually a mapped asset pack) to OpenGL.
+		std::size_t numLevels = (m_mipMapped ? atlas.levels.size() : 1);
+		for (std::size_t level = 0; level < numLevels; level++)
 		{
-			  // build our texture mipmaps
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            makeMipmaps(byteCount, textureWidth, textureHeight, imageData);
+			const AtlasLevel& l = atlas.levels[level];
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA, l.width, l.height, 0,
+						 GL_RGBA, GL_UNSIGNED_BYTE, l.pixels);
 		}
-		else
-		{
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-			if (3 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData);
-			else if (4 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData);
-		}
-
-		delete [] imageData;
-
-		m_imageMap[spriteID] = glTextureID;
 
 		return true;
 	}
 
-	int getNumFrames(int imageID) const
+	virtual int getNumFrames(int imageID) const
 	{
-		auto it = m_frameCountPerSprite.find(imageID);
-		if (it == m_frameCountPerSprite.end())
+		if (imageID < 0  ||  static_cast<std::size_t>(imageID) >= m_frameCountPerSprite.size())
 			return 0;
 
-		return it->second;
+		return m_frameCountPerSprite[imageID];
 	}
 
-	bool plotSprite(int imageID, int frame, double x, double y, int angleDegrees, double size)
+	  // Batched drawing: queueSprite() only records the sprite's quad;
+	  // flushSprites() then submits all queued quads, which share the atlas
+	  // texture, with a single vertex-array draw call.  Flush whenever draw
+	  // order matters (e.g., after each depth).
+
+	virtual bool queueSprite(int imageID, int frame, double x, double y, int angleDegrees, double size)
 	{
 		int spriteID = getSpriteID(imageID, frame);
 		if (INVALID_SPRITE_ID == spriteID)
 			return false;
 
-		auto it = m_imageMap.find(spriteID);
-		if (it == m_imageMap.end())
+		if (static_cast<std::size_t>(spriteID) >= m_spriteRects.size()  ||  !m_spriteRects[spriteID].valid)
 			return false;
+		const AtlasRect& rect = m_spriteRects[spriteID];
 
-		glPushMatrix();
-
-		double finalWidth, finalHeight;
+		double finalWidth = SPRITE_WIDTH_GL * size;
+		double finalHeight = SPRITE_HEIGHT_GL * size;
 
-		finalWidth = SPRITE_WIDTH_GL * size;
-		finalHeight = SPRITE_HEIGHT_GL * size;
+		double gx, gy, gz;
+		convertToGlutCoords(x, y, gx, gy, gz);
 
-		// object's x/y location is center-based, but sprite plotting is upper-left-corner based
-		const double xoffset = 0;// finalWidth / 2;
-		const double yoffset = 0;// finalHeight / 2;
+		static const double corners[4][2] = { { -.5, -.5 }, { .5, -.5 }, { .5, .5 }, { -.5, .5 } };
+		for (int k = 0; k < 4; k++)
+		{
+			double rx, ry;
+			rotate(corners[k][0] * finalWidth, corners[k][1] * finalHeight, angleDegrees, rx, ry);
+			m_batch.vertices.push_back(static_cast<GLfloat>(gx + rx));
+			m_batch.vertices.push_back(static_cast<GLfloat>(gy + ry));
+			m_batch.vertices.push_back(static_cast<GLfloat>(gz));
+			m_batch.texCoords.push_back(corners[k][0] < 0 ? rect.s0 : rect.s1);
+			m_batch.texCoords.push_back(corners[k][1] < 0 ? rect.t0 : rect.t1);
+		}
+		return true;
+	}
 
-        double gx, gy, gz;
-        convertToGlutCoords(x, y, gx, gy, gz);
-		glTranslatef(static_cast<GLfloat>(gx-xoffset),static_cast<GLfloat>(gy-yoffset),static_cast<GLfloat>(gz));
+	virtual void flushSprites()
+	{
 		glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		glEnable(GL_TEXTURE_2D);
 		glDisable(GL_DEPTH_TEST);
-		glEnable (GL_BLEND);
+		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glBindTexture(GL_TEXTURE_2D, it->second);
-
 		glColor3f(1.0, 1.0, 1.0);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
-		double cx1,cx2,cx3,cx4;
-		double cy1,cy2,cy3,cy4;
-
-		cx1 = cy1 = 0;
-		cx2 = 1; cy2 = 0;
-		cx3 = 1; cy3 = 1;
-		cx4 = 0; cy4 = 1;
-
-		double rx1, ry1, rx2, ry2, rx3, ry3, rx4, ry4;
-		rotate(-finalWidth/2, -finalHeight/2, angleDegrees, rx1, ry1);
-		rotate(finalWidth/2, -finalHeight/2, angleDegrees, rx2, ry2);
-		rotate(finalWidth/2, finalHeight/2, angleDegrees, rx3, ry3);
-		rotate(-finalWidth/2, finalHeight/2, angleDegrees, rx4, ry4);
-
-		glBegin(GL_QUADS);
-		glTexCoord2d(cx1, cy1);
-		glVertex3f(static_cast<GLfloat>(rx1), static_cast<GLfloat>(ry1), 0);
-		glTexCoord2d(cx2, cy2);
-		glVertex3f(static_cast<GLfloat>(rx2), static_cast<GLfloat>(ry2), 0);
-		glTexCoord2d(cx3, cy3);
-		glVertex3f(static_cast<GLfloat>(rx3), static_cast<GLfloat>(ry3), 0);
-		glTexCoord2d(cx4, cy4);
-		glVertex3f(static_cast<GLfloat>(rx4), static_cast<GLfloat>(ry4), 0);
-		glEnd();
-
-
-		/*
-		glBegin (GL_QUADS);
-		  glTexCoord2d(cx1, cy1);
-		  glVertex3f(0, 0, 0);
-		  glTexCoord2d(cx2, cy2);
-		  glVertex3f(static_cast<GLfloat>(finalWidth), 0, 0);
-		  glTexCoord2d(cx3, cy3);
-		  glVertex3f(static_cast<GLfloat>(finalWidth), static_cast<GLfloat>(finalHeight), 0);
-		  glTexCoord2d(cx4, cy4);
-		  glVertex3f(0, static_cast<GLfloat>(finalHeight), 0);
-		glEnd();
-		*/
+		if (!m_batch.vertices.empty())
+		{
+			glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+			glVertexPointer(3, GL_FLOAT, 0, m_batch.vertices.data());
+			glTexCoordPointer(2, GL_FLOAT, 0, m_batch.texCoords.data());
+			glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(m_batch.vertices.size() / 3));
+			m_batch.vertices.clear();		// keeps its capacity for the next frame
+			m_batch.texCoords.clear();
+		}
 
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
 		glDisable(GL_TEXTURE_2D);
 		glEnable(GL_DEPTH_TEST);
-
 		glPopAttrib();
-		glPopMatrix();
-
-		return true;
 	}
 
 	~SpriteManager()
 	{
-		for (auto it = m_imageMap.begin(); it != m_imageMap.end(); it++)
-			glDeleteTextures(1, &it->second);
+		if (m_atlasTexture != 0)
+			glDeleteTextures(1, &m_atlasTexture);
 	}
 
 private:
 
-	static void rotate(double x, double y, double degrees, double& xout, double& yout)
+	struct QuadBatch
 	{
-        static const double PI = 4 * atan(1.0);
-		double theta = (degrees / 360.0) * (2 * PI);
-		xout = x * cos(theta) - y * sin(theta);
-		yout = y * cos(theta) + x * sin(theta);
-	}
-    
-    static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz)
-    {
-        x /= VIEW_WIDTH;
-        y /= VIEW_HEIGHT;
-        gx = 2 * VISIBLE_MIN_X + .3 + x * 2 * (VISIBLE_MAX_X - VISIBLE_MIN_X);
-        gy = 2 * VISIBLE_MIN_Y +      y * 2 * (VISIBLE_MAX_Y - VISIBLE_MIN_Y);
-        gz = .6 * VISIBLE_MIN_Z;
-    }
+		std::vector<GLfloat> vertices;	// x, y, z for each corner
+		std::vector<GLfloat> texCoords;	// s, t for each corner
+	};
+
+	struct AtlasRect
+	{
+		bool	valid;
+		GLfloat s0, t0, s1, t1;
+	};
 
 	bool					m_mipMapped;
-	std::map<int, GLuint>	m_imageMap;
-	std::map<int, int>		m_frameCountPerSprite;
+	GLuint					m_atlasTexture;
+	std::vector<AtlasRect>	m_spriteRects;			// indexed by sprite ID
+	std::vector<int>		m_frameCountPerSprite;	// indexed by image ID
+	QuadBatch				m_batch;
 
 	static const int INVALID_SPRITE_ID = -1;
 	static const int MAX_IMAGES = 1000;
@@ -261,23 +212,11 @@ private:
 
 	int getSpriteID(int imageID, int frame) const
 	{
-		if (imageID >= MAX_IMAGES || frame >= MAX_FRAMES_PER_SPRITE)
+		if (imageID < 0 || imageID >= MAX_IMAGES || frame < 0 || frame >= MAX_FRAMES_PER_SPRITE)
 			return INVALID_SPRITE_ID;
 
 		return imageID * MAX_FRAMES_PER_SPRITE + frame;
 	}
-    
-    void makeMipmaps(unsigned char byteCount, unsigned int textureWidth, unsigned int textureHeight, char* imageData)
-    {
-        int format = (byteCount == 3 ? GL_BGR : GL_BGRA);
-#ifdef __APPLE__
-        int internalFormat = (byteCount == 3 ? GL_RGB : GL_RGBA);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, textureWidth, textureHeight, 0, format, GL_UNSIGNED_BYTE, imageData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-#else
-        gluBuild2DMipmaps(GL_TEXTURE_2D, byteCount, textureWidth, textureHeight, format, GL_UNSIGNED_BYTE, imageData);
-#endif
-    }
 };
 
 #endif // SPRITEMANAGER_H_
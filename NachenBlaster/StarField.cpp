@@ -0,0 +1,62 @@
+#include "StarField.h"
+#include "GameConstants.h"
+using namespace std;
+
+StarField::StarField(GraphObjectRegistry& registry)
+: SpriteBatch(registry, 3)
+{
+}
+
+void StarField::addStar(double x, double y, double size)
+{
+    m_x.push_back(static_cast<float>(x));
+    m_y.push_back(static_cast<float>(y));
+    m_size.push_back(static_cast<float>(size));
+}
+
+void StarField::scroll()
+{
+    size_t n = m_x.size();
+    float* x = m_x.data();
+    float* y = m_y.data();
+    float* s = m_size.data();
+    size_t kept = 0;
+    for(size_t i = 0; i < n; i++)       //a star at the left edge disappears instead of moving
+    {
+        x[kept] = x[i];
+        y[kept] = y[i];
+        s[kept] = s[i];
+        kept += (x[i] > 0);
+    }
+    m_x.resize(kept);
+    m_y.resize(kept);
+    m_size.resize(kept);
+    for(size_t i = 0; i < kept; i++)    //branch-free so the compiler can vectorize it
+        x[i] -= 1;
+}
+
+void StarField::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_size.clear();
+}
+
+size_t StarField::getNumStars() const
+{
+    return m_x.size();
+}
+
+size_t StarField::getNumSprites() const
+{
+    return m_x.size();
+}
+
+void StarField::getSprite(size_t index, double alpha, int& imageID, double& x, double& y, int& dir, double& size) const
+{   //every star moves one pixel left per tick, so where it was is known without storing it
+    imageID = IID_STAR;
+    x = m_x[index] + (1 - alpha);
+    y = m_y[index];
+    dir = 0;
+    size = m_size[index];
+}
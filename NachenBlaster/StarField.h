@@ -0,0 +1,27 @@
+#ifndef STARFIELD_H_
+#define STARFIELD_H_
+
+#include "GraphObject.h"
+#include <vector>
+#include <cstddef>
+
+//////////////STARFIELD///////////////
+//the background stars, kept in flat arrays instead of one actor per star,
+//so thousands of them cost one tight loop per tick and no allocations
+class StarField : public SpriteBatch
+{
+public:
+    StarField(GraphObjectRegistry& registry);
+    void addStar(double x, double y, double size);  //introduce a star at the location
+    void scroll();                      //remove the stars at the left edge and move the rest one pixel left
+    void clear();                       //remove all stars
+    std::size_t getNumStars() const;    //return number of stars
+    virtual std::size_t getNumSprites() const;
+    virtual void getSprite(std::size_t index, double alpha, int& imageID, double& x, double& y, int& dir, double& size) const;
+private:
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_size;
+};
+
+#endif // STARFIELD_H_
@@ -0,0 +1,53 @@
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <cstdint>
+#include <cstring>
+
+  // Accumulates an FNV-1a hash of game state values, used to checksum a
+  // world so that a replayed session can be checked against the recording.
+
+class StateHash
+{
+  public:
+	StateHash()
+	 : m_hash(14695981039346656037ULL)
+	{
+	}
+
+	void add(std::uint64_t value)
+	{
+		for (int k = 0; k < 8; k++)
+		{
+			m_hash ^= (value >> (8 * k)) & 0xff;
+			m_hash *= 1099511628211ULL;
+		}
+	}
+
+	void add(double value)
+	{
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		add(bits);
+	}
+
+	void add(int value)
+	{
+		add(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+	}
+
+	void add(unsigned int value)
+	{
+		add(static_cast<std::uint64_t>(value));
+	}
+
+	std::uint64_t getHash() const
+	{
+		return m_hash;
+	}
+
+  private:
+	std::uint64_t m_hash;
+};
+
+#endif // STATEHASH_H_
@@ -1,9 +1,9 @@
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "Profiler.h"
+#include "Collision.h"
 #include <string>
 #include <vector>
-#include <sstream>
-#include <iomanip>
 #include <cmath>
 using namespace std;
 
@@ -13,13 +13,14 @@ GameWorld* createStudentWorld(string assetDir)
 }
 
 StudentWorld::StudentWorld(string assetDir)
-: GameWorld(assetDir)
+: GameWorld(assetDir), m_starField(getGraphObjects())
 {
     m_blaster = nullptr;
     destroyed = 0;
     needDestroy = 0;
     maxShips = 0;
     curNumShips = 0;
+    reclaimed = 0;
 }
 
 int StudentWorld::init()
@@ -30,8 +31,7 @@ int StudentWorld::init()
         double s_x = randInt(0, VIEW_WIDTH - 1);
         double s_y = randInt(0, VIEW_HEIGHT - 1);
         double s_size = static_cast<double>(randInt(5, 50)) / 100;
-        Star* s = new Star(s_x, s_y, s_size, this);
-        m_actors.push_back(s);
+        m_starField.addStar(s_x, s_y, s_size);
     }
     curNumShips = 0;
     destroyed = 0;
@@ -42,27 +42,40 @@ int StudentWorld::init()
 
 int StudentWorld::move()
 {
-    introduceStar();        //introduce stars
-    introduceAlien();       //introduce aliens
-    if(m_blaster->isAlive())        //let NachenBlaster do something if it is alive
-        m_blaster->doSomething();
+    NB_PROFILE_SCOPE(PROFILE_TICK);
+    {
+        NB_PROFILE_SCOPE(PROFILE_INTRODUCE_STAR);
+        introduceStar();        //introduce stars
+    }
+    {
+        NB_PROFILE_SCOPE(PROFILE_INTRODUCE_ALIEN);
+        introduceAlien();       //introduce aliens
+    }
+    {
+        NB_PROFILE_SCOPE(PROFILE_BLASTER);
+        if(m_blaster->isAlive())        //let NachenBlaster do something if it is alive
+            m_blaster->doSomething();
+    }
     if(!m_blaster->isAlive())
         return GWSTATUS_PLAYER_DIED;
     if(completeLevel())
         return GWSTATUS_FINISHED_LEVEL;
-    for(int i = 0; i < m_actors.size(); i++)    //let each actor do something if it is alive
+    int status;
     {
-        if(m_actors[i]->isAlive())
-        {
-            m_actors[i]->doSomething();
-            if(!m_blaster->isAlive())
-                return GWSTATUS_PLAYER_DIED;
-            if(completeLevel())
-                return GWSTATUS_FINISHED_LEVEL;
-        }
+        NB_PROFILE_SCOPE(PROFILE_ACTORS);
+        m_starField.scroll();       //move the stars
+        status = updateAll();       //let every other actor do something, in the order introduced
+    }
+    if(status != GWSTATUS_CONTINUE_GAME)
+        return status;
+    {
+        NB_PROFILE_SCOPE(PROFILE_REMOVE_DEAD);
+        removeDead();       //remove the dead actors from the screen
+    }
+    {
+        NB_PROFILE_SCOPE(PROFILE_UPDATE_TEXT);
+        updateText();       //update text on the screen
     }
-    removeDead();       //remove the dead actors from the screen
-    updateText();       //update text on the screen
     return GWSTATUS_CONTINUE_GAME;
 }
 
@@ -70,19 +83,35 @@ void StudentWorld::cleanUp()    //delete all actors
 {
     delete m_blaster;
     m_blaster = nullptr;
-    if(!m_actors.empty())
+    m_starField.clear();
+    deleteAll(m_actors);
+    m_aliens.clear();
+    m_alienGrid.clear();
+}
+
+uint64_t StudentWorld::checksum() const
+{
+    StateHash hash;
+    hash.add(GameWorld::checksum());
+    hash.add(destroyed);
+    hash.add(needDestroy);
+    hash.add(curNumShips);
+    if(m_blaster != nullptr)
     {
-        std::vector<Actor*>::iterator p = m_actors.begin();
-        while(p != m_actors.end())
-        {
-            delete *p;
-            p = m_actors.erase(p);
-        }
-        m_actors.clear();
+        hash.add(m_blaster->getX());
+        hash.add(m_blaster->getY());
+        hash.add(m_blaster->getHealth());
+        hash.add(m_blaster->getCabbage());
+        hash.add(m_blaster->getTorpedoe());
     }
+    hash.add(static_cast<uint64_t>(m_starField.getNumStars()));
+    hashAll(m_actors, hash);
+    for(size_t i = 0; i < m_aliens.size(); i++)
+        hash.add(m_aliens[i]->getHealth());
+    return hash.getHash();
 }
 
-bool StudentWorld::targetAtNachenBlaster(string user, double x, double y, double r, int pts)
+bool StudentWorld::targetAtNachenBlaster(Collider user, double x, double y, double r, int pts)
 {
     if(overlap(x, y, r, m_blaster->getX(), m_blaster->getY(), m_blaster->getRadius()))
     //if the specified position is close enough to NachenBlaster, a collision happens
@@ -93,12 +122,12 @@ bool StudentWorld::targetAtNachenBlaster(string user, double x, double y, double
             m_blaster->setDead();
             decLives();
         }
-        else if(user == "PROJECTILE")       //if the colliding object is projectile, play this sound effect
-            playSound(SOUND_BLAST);
-        else if(user == "ALIEN")            //if the colliding object is alien, play this sound effect
-            playSound(SOUND_DEATH);
-        else if(user == "GOODIE")           //if the colliding object is goodie, play this sound effect
-            playSound(SOUND_GOODIE);
+        else if(user == COLLIDER_PROJECTILE)    //if the colliding object is projectile, play this sound effect
+            postEvent(EVENT_HIT, SOUND_BLAST);
+        else if(user == COLLIDER_ALIEN)         //if the colliding object is alien, play this sound effect
+            postEvent(EVENT_KILL, SOUND_DEATH);
+        else if(user == COLLIDER_GOODIE)        //if the colliding object is goodie, play this sound effect
+            postEvent(EVENT_PICKUP, SOUND_GOODIE);
         return true;
     }
     return false;
@@ -106,49 +135,44 @@ bool StudentWorld::targetAtNachenBlaster(string user, double x, double y, double
 
 bool StudentWorld::targetAtAlien(double x, double y, double r, int pts)
 {
-    for(int i = 0; i < m_actors.size(); i++)        //check each actor
+    Alien* a = m_alienGrid.firstHit(x, y, r);
+    if(a != nullptr)
+    //if the specified position is close enough to an alien, a collision happens
     {
-        if(m_actors[i]->isAlien())                  //make sure the actor is an alien
+        a->decreaseHealth(pts);         //decrease health as specified
+        if(a->getHealth() <= 0)
+        //if the alien is health drops below 0 because of the collision, play this sound effect, set its state to dead, inform the StudentWorld, introduce an explosion and increase score
         {
-            if(overlap(x, y, r, m_actors[i]->getX(), m_actors[i]->getY(), m_actors[i]->getRadius()))
-            //if the specified position is close enough to the alien, a collision happens
+            postEvent(EVENT_KILL, SOUND_DEATH);
+            a->setDead();
+            needDestroy--;
+            destroyed++;
+            createExplosion(a->getX(), a->getY());
+            increaseScore(a->returnScore());
+            if(a->isSmoregon())
+            //if the alien is Smoregon, there is a chance it will drop certain goodie
             {
-                static_cast<Alien*>(m_actors[i])->decreaseHealth(pts);      //decrease health as specified
-                if(static_cast<Alien*>(m_actors[i])->getHealth() <= 0)
-                //if the alien is health drops below 0 because of the collision, play this sound effect, set its state to dead, inform the StudentWorld, introduce an explosion and increase score
+                int r1 = randInt(1, 3);
+                if(r1 == 1)
                 {
-                    playSound(SOUND_DEATH);
-                    m_actors[i]->setDead();
-                    needDestroy--;
-                    destroyed++;
-                    createExplosion(m_actors[i]->getX(), m_actors[i]->getY());
-                    increaseScore(static_cast<Alien*>(m_actors[i])->returnScore());
-                    if(static_cast<Alien*>(m_actors[i])->isSmoregon())
-                    //if the alien is Smoregon, there is a chance it will drop certain goodie
-                    {
-                        int r1 = randInt(1, 3);
-                        if(r1 == 1)
-                        {
-                            int r2 = randInt(1, 2);
-                            switch(r2)
-                            {
-                                case 1: createRepairGoodie(m_actors[i]->getX(), m_actors[i]->getY()); break;
-                                case 2: createTorpedoeGoodie(m_actors[i]->getX(), m_actors[i]->getY()); break;
-                            }
-                        }
-                    }
-                    else if(static_cast<Alien*>(m_actors[i])->isSnagglegon())
-                    //if the alien is Snagglegon, there is a chance it will drop certain goodie
+                    int r2 = randInt(1, 2);
+                    switch(r2)
                     {
-                        int r = randInt(1, 6);
-                        if(r == 1)
-                            createExtraLifeGoodie(m_actors[i]->getX(), m_actors[i]->getY());
+                        case 1: createRepairGoodie(a->getX(), a->getY()); break;
+                        case 2: createTorpedoeGoodie(a->getX(), a->getY()); break;
                     }
                 }
-                else playSound(SOUND_BLAST);
-                return true;
+            }
+            else if(a->isSnagglegon())
+            //if the alien is Snagglegon, there is a chance it will drop certain goodie
+            {
+                int r = randInt(1, 6);
+                if(r == 1)
+                    createExtraLifeGoodie(a->getX(), a->getY());
             }
         }
+        else postEvent(EVENT_HIT, SOUND_BLAST);
+        return true;
     }
     return false;
 }
@@ -161,46 +185,68 @@ bool StudentWorld::closeToBlaster(double x, double y) const   //check overlap ac
 void StudentWorld::createCabbage(double startX, double startY, Actor* owner)
 //introduce a cabbage with the sound effect
 {
-    m_actors.push_back(new Cabbage(startX, startY, owner));
-    playSound(SOUND_PLAYER_SHOOT);
+    addActor(new (getActorPools()) Cabbage(startX, startY, owner));
+    postEvent(EVENT_FIRE, SOUND_PLAYER_SHOOT);
 }
 
 void StudentWorld::createTorpedoe(double startX, double startY, Actor* owner)
 //introduce a tropedoe with the sound effect
 {
-    m_actors.push_back(new Torpedoe(startX, startY, owner));
-    playSound(SOUND_TORPEDO);
+    addActor(new (getActorPools()) Torpedoe(startX, startY, owner));
+    postEvent(EVENT_FIRE, SOUND_TORPEDO);
 }
 
 void StudentWorld::createTurnip(double startX, double startY, Actor* owner)
 //introduce a turnip with the sound effect
 {
-    m_actors.push_back(new Turnip(startX, startY, owner));
-    playSound(SOUND_ALIEN_SHOOT);
+    addActor(new (getActorPools()) Turnip(startX, startY, owner));
+    postEvent(EVENT_FIRE, SOUND_ALIEN_SHOOT);
 }
 
 void StudentWorld::createRepairGoodie(double startX, double startY)
 //introduce a repair goodie with the sound effect
 {
-    m_actors.push_back(new RepairLifeGoodie(startX, startY, this));
+    addActor(new (getActorPools()) RepairLifeGoodie(startX, startY, this));
 }
 
 void StudentWorld::createExtraLifeGoodie(double startX, double startY)
 //introduce an extra life goodie with the sound effect
 {
-    m_actors.push_back(new ExtraLifeGoodie(startX, startY, this));
+    addActor(new (getActorPools()) ExtraLifeGoodie(startX, startY, this));
 }
 
 void StudentWorld::createTorpedoeGoodie(double startX, double startY)
 //introduce a torpedoe goodie with the sound effect
 {
-    m_actors.push_back(new TorpedoeGoodie(startX, startY, this));
+    addActor(new (getActorPools()) TorpedoeGoodie(startX, startY, this));
 }
 
 void StudentWorld::createExplosion(double startX, double startY)
 //introduce an explosion with the sound effect
 {
-    m_actors.push_back(new Explosion(startX, startY, this));
+    addActor(new (getActorPools()) Explosion(startX, startY, this));
+}
+
+void StudentWorld::addActor(Actor* a)
+{
+    m_actors.push_back(a);
+}
+
+void StudentWorld::addAlien(Alien* a)
+{
+    m_aliens.push_back(a);
+    m_actors.push_back(a);
+    m_alienGrid.insert(a);
+}
+
+void StudentWorld::alienMoved(Alien* a)
+{
+    m_alienGrid.update(a);
+}
+
+int StudentWorld::getReclaimedCount() const
+{
+    return reclaimed;
 }
 
 void StudentWorld::destroyAlien()
@@ -234,8 +280,7 @@ void StudentWorld::introduceStar()
     {
         double s_y = randInt(0, VIEW_HEIGHT - 1);
         double s_size = static_cast<double>(randInt(5, 50)) / 100;
-        Star* s = new Star(VIEW_WIDTH - 1, s_y, s_size, this);
-        m_actors.push_back(s);
+        m_starField.addStar(VIEW_WIDTH - 1, s_y, s_size);
     }
 }
 
@@ -252,36 +297,29 @@ void StudentWorld::introduceAlien()
         int s3 = 5 + 10 * getLevel();
         int s = s1 + s2 + s3;
         int r = randInt(1, s);
+        int a_y = randInt(0, VIEW_HEIGHT - 1);
+        Alien* a;
         if(r >= 1 && r <= s1)
-        {
-            int a_y = randInt(0, VIEW_HEIGHT - 1);
-            m_actors.push_back(new Smallgon(VIEW_WIDTH - 1, a_y, this));
-        }
+            a = new (getActorPools()) Smallgon(VIEW_WIDTH - 1, a_y, this);
         else if(r > s1 && r <= s1 + s2)
-        {
-            int a_y = randInt(0, VIEW_HEIGHT - 1);
-            m_actors.push_back(new Smoregon(VIEW_WIDTH - 1, a_y, this));
-        }
+            a = new (getActorPools()) Smoregon(VIEW_WIDTH - 1, a_y, this);
         else
-        {
-            int a_y = randInt(0, VIEW_HEIGHT - 1);
-            m_actors.push_back(new Snagglegon(VIEW_WIDTH - 1, a_y, this));
-        }
+            a = new (getActorPools()) Snagglegon(VIEW_WIDTH - 1, a_y, this);
+        addAlien(a);
         curNumShips++;
     }
 }
 
 bool StudentWorld::overlap(double x1, double y1, double r1, double x2, double y2, double r2)
 {
-    double dis = sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2));
-    return dis < (0.75 * (r1 + r2));
+    return circlesOverlap(x1, y1, r1, x2, y2, r2);
 }
 
 bool StudentWorld::completeLevel()
 {
     if(needDestroy == 0)
     {
-        playSound(SOUND_FINISHED_LEVEL);
+        postEvent(EVENT_LEVEL_COMPLETE, SOUND_FINISHED_LEVEL);
         return true;
     }
     else return false;
@@ -289,30 +327,83 @@ bool StudentWorld::completeLevel()
 
 void StudentWorld::removeDead()
 {
-    std::vector<Actor*>::iterator p;
-    for(p = m_actors.begin(); p != m_actors.end(); p++)
+    for(size_t i = 0; i < m_aliens.size(); i++)     //dead aliens leave the grid and free up a slot for a new ship
     {
-        if(!((*p)->isAlive()))
+        if(!m_aliens[i]->isAlive())
+        {
+            curNumShips--;
+            m_alienGrid.remove(m_aliens[i]);
+        }
+    }
+    size_t kept = 0;
+    for(size_t i = 0; i < m_actors.size(); i++)     //every dead actor is in m_actors, so it fills the graveyard
+    {
+        if(m_actors[i]->isAlive())
+            m_actors[kept++] = m_actors[i];
+        else m_graveyard.push_back(m_actors[i]);
+    }
+    m_actors.resize(kept);
+    removeDeadFrom(m_aliens);
+    for(size_t i = 0; i < m_graveyard.size(); i++)  //destroy the dead actors once both lists are compacted
+        delete m_graveyard[i];
+    reclaimed = static_cast<int>(m_graveyard.size());
+    m_graveyard.clear();
+}
+
+int StudentWorld::updateAll()
+{
+    for(size_t i = 0; i < m_actors.size(); i++) //actors introduced while updating are appended, and act this tick too
+    {
+        if(m_actors[i]->isAlive())
         {
-            if((*p)->isAlien())
-                curNumShips--;
-            delete *p;
-            p = m_actors.erase(p);
-            p--;
+            m_actors[i]->doSomething();
+            if(!m_blaster->isAlive())
+                return GWSTATUS_PLAYER_DIED;
+            if(completeLevel())
+                return GWSTATUS_FINISHED_LEVEL;
         }
     }
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+template<typename T>
+void StudentWorld::removeDeadFrom(std::vector<T*>& pool)
+//keep the live actors in order in a single pass
+{
+    size_t kept = 0;
+    for(size_t i = 0; i < pool.size(); i++)
+    {
+        if(pool[i]->isAlive())
+            pool[kept++] = pool[i];
+    }
+    pool.resize(kept);
+}
+
+template<typename T>
+void StudentWorld::hashAll(const std::vector<T*>& pool, StateHash& hash)
+{
+    hash.add(static_cast<uint64_t>(pool.size()));
+    for(size_t i = 0; i < pool.size(); i++)
+    {
+        hash.add(pool[i]->getX());
+        hash.add(pool[i]->getY());
+        hash.add(pool[i]->getDirection());
+        hash.add(pool[i]->getSize());
+    }
+}
+
+template<typename T>
+void StudentWorld::deleteAll(std::vector<T*>& pool)
+{
+    for(size_t i = 0; i < pool.size(); i++)
+        delete pool[i];
+    pool.clear();
 }
 
-void StudentWorld::updateText()
+void StudentWorld::updateText()     //pass the text on only when one of the values shown has changed
 {
-    ostringstream text;
-    text.setf(ios::fixed);
-    text.precision(0);
-    text.fill(' ');
-    text << "Lives: " << getLives() << setw(10) << "Health: " << m_blaster->getHealth() * 2 << "%"
-    << setw(9) << "Score: " << getScore() << setw(9) << "Level: " << getLevel() << setw(12)
-    << "Cabbages: " << m_blaster->getCabbage() * 100 / 30 << "%" << setw(13) << "Torpedoes: "
-    << m_blaster->getTorpedoe();
-    setGameStatText(text.str());
+    if(m_hud.update(getLives(), m_blaster->getHealth() * 2, getScore(), getLevel(),
+                    m_blaster->getCabbage() * 100 / 30, m_blaster->getTorpedoe()))
+        setGameStatText(m_hud.getText());
 }
 
@@ -3,9 +3,14 @@
 
 #include "GameWorld.h"
 #include "Actor.h"
+#include "AlienGrid.h"
+#include "StarField.h"
+#include "HudText.h"
 #include <string>
 #include <vector>
 
+enum Collider { COLLIDER_PROJECTILE, COLLIDER_ALIEN, COLLIDER_GOODIE };   //what is running into the NachenBlaster
+
 class StudentWorld : public GameWorld
 {
 public:
@@ -13,7 +18,8 @@ public:
     virtual int init();
     virtual int move();
     virtual void cleanUp();
-    bool targetAtNachenBlaster(std::string user, double x, double y, double r, int pts);
+    virtual std::uint64_t checksum() const;
+    bool targetAtNachenBlaster(Collider user, double x, double y, double r, int pts);
     //check if the position can collide with the NachenBlaster and decrease its health by pts
     bool targetAtAlien(double x, double y, double r, int pts);
     //check if the position can collide with the alien and decrease health by pts
@@ -30,19 +36,35 @@ public:
     void createTorpedoeGoodie(double startX, double startY);        //introduce a torpedoe goodie at the location
     void createExtraLifeGoodie(double startX, double startY);       //introduce a life goodie at the locate
     void createExplosion(double startX, double startY);             //introduce an explosion at the location
+    void alienMoved(Alien* a);                                      //keep the alien grid up to date after an alien moves
+    int getReclaimedCount() const;                                  //return number of actors removed by the last tick
     ~StudentWorld();
 private:
+    friend class WorldBenchmark;    //measures the private operations below
     void introduceStar();
     void introduceAlien();
     bool overlap(double x1, double y1, double r1, double x2, double y2, double r2);
     bool completeLevel();
     void removeDead();
+    void addActor(Actor* a);                                        //add a to the end of m_actors
+    void addAlien(Alien* a);                                        //add a to m_aliens, m_actors and the alien grid
+    int updateAll();                                                //let each live actor do something, in m_actors order
+    template<typename T> void removeDeadFrom(std::vector<T*>& pool);
+    template<typename T> void deleteAll(std::vector<T*>& pool);
+    template<typename T> static void hashAll(const std::vector<T*>& pool, StateHash& hash);
     void updateText();
     int destroyed;
     int needDestroy;
     int maxShips;
     int curNumShips;
-    std::vector<Actor*> m_actors;
+    int reclaimed;
+    StarField m_starField;
+    HudText m_hud;
+    std::vector<Actor*> m_actors;               //every actor but the NachenBlaster, in the order introduced,
+                                                //which is the order they act in
+    std::vector<Alien*> m_aliens;               //the aliens in m_actors, to keep the ship count and alien grid
+    std::vector<Actor*> m_graveyard;            //dead actors waiting to be destroyed at the end of removeDead
+    AlienGrid m_alienGrid;
     NachenBlaster* m_blaster;
 };
 
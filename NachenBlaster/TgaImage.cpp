@@ -0,0 +1,76 @@
+#include "TgaImage.h"
+#include <fstream>
+using namespace std;
+
+static const size_t TGA_HEADER_SIZE = 18;
+
+bool loadTga(string filename, RgbaImage& image)
+{
+	ifstream tgaFile(filename, ios::in|ios::binary);
+	if (!tgaFile)
+		return false;
+	  // one read for the whole file
+	tgaFile.seekg(0, ios::end);
+	streamoff fileSize = tgaFile.tellg();
+	if (fileSize < static_cast<streamoff>(TGA_HEADER_SIZE))
+		return false;
+	vector<unsigned char> contents(static_cast<size_t>(fileSize));
+	tgaFile.seekg(0);
+	if (!tgaFile.read(reinterpret_cast<char*>(contents.data()), fileSize))
+		return false;
+
+	  //image type either 2 (color) or 3 (greyscale)
+	if (contents[1] != 0  ||  (contents[2] != 2  &&  contents[2] != 3))
+		return false;
+
+	unsigned int width = contents[12] + contents[13] * 256;
+	unsigned int height = contents[14] + contents[15] * 256;
+	unsigned int byteCount = contents[16] / 8;
+	if (byteCount != 3  &&  byteCount != 4)
+		return false;
+	size_t imageSize = static_cast<size_t>(width) * height * byteCount;
+	if (contents.size() < TGA_HEADER_SIZE + imageSize)
+		return false;
+
+	  // TGA pixels are BGR or BGRA
+	const unsigned char* in = contents.data() + TGA_HEADER_SIZE;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 4);
+	for (size_t k = 0; k < static_cast<size_t>(width) * height; k++, in += byteCount)
+	{
+		image.pixels[4*k  ] = in[2];
+		image.pixels[4*k+1] = in[1];
+		image.pixels[4*k+2] = in[0];
+		image.pixels[4*k+3] = (4 == byteCount ? in[3] : 255);
+	}
+	return true;
+}
+
+bool saveTga(string filename, const RgbaImage& image)
+{
+	ofstream tgaFile(filename, ios::out|ios::binary);
+	if (!tgaFile)
+		return false;
+
+	unsigned char header[TGA_HEADER_SIZE] = { 0 };
+	header[2] = 2;
+	header[12] = image.width % 256;
+	header[13] = image.width / 256;
+	header[14] = image.height % 256;
+	header[15] = image.height / 256;
+	header[16] = 32;
+	header[17] = 8;		// alpha bits; origin at the bottom left
+	tgaFile.write(reinterpret_cast<const char*>(header), TGA_HEADER_SIZE);
+
+	vector<unsigned char> bgra(image.pixels.size());
+	for (size_t k = 0; k < image.pixels.size(); k += 4)
+	{
+		bgra[k  ] = image.pixels[k+2];
+		bgra[k+1] = image.pixels[k+1];
+		bgra[k+2] = image.pixels[k];
+		bgra[k+3] = image.pixels[k+3];
+	}
+	tgaFile.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+	return static_cast<bool>(tgaFile);
+}
@@ -0,0 +1,35 @@
+#ifndef TGAIMAGE_H_
+#define TGAIMAGE_H_
+
+#include <string>
+#include <vector>
+
+  // An image as 8-bit RGBA pixels, bottom row first (as OpenGL and TGA
+  // files store them).
+
+struct RgbaImage
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::vector<unsigned char> pixels;
+
+	unsigned char* row(unsigned int y)
+	{
+		return &pixels[static_cast<std::size_t>(y) * width * 4];
+	}
+
+	const unsigned char* row(unsigned int y) const
+	{
+		return &pixels[static_cast<std::size_t>(y) * width * 4];
+	}
+};
+
+  // Read an uncompressed 24- or 32-bit color (type 2) or greyscale (type 3)
+  // TGA file, the kinds the game's sprites come in.  24-bit images are given
+  // an opaque alpha.
+bool loadTga(std::string filename, RgbaImage& image);
+
+  // Write image as an uncompressed 32-bit TGA file
+bool saveTga(std::string filename, const RgbaImage& image);
+
+#endif // TGAIMAGE_H_
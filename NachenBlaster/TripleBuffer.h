@@ -0,0 +1,61 @@
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <atomic>
+
+  // Hands the latest of a stream of values from one producer thread to one
+  // consumer thread without locks.  The producer fills back() and calls
+  // publish(); the consumer calls front() to get the most recently
+  // published value.  Neither ever waits for the other: the producer always
+  // has a slot to fill, and the consumer keeps the slot it is reading until
+  // it asks for a newer one.  Values the consumer never gets to see are
+  // simply overwritten.
+
+template<typename T>
+class TripleBuffer
+{
+  public:
+	TripleBuffer()
+	 : m_back(0), m_middle(1), m_front(2)
+	{
+	}
+
+	  // Producer only: the slot to fill next
+	T& back()
+	{
+		return m_slots[m_back];
+	}
+
+	  // Producer only: make the filled slot the latest value
+	void publish()
+	{
+		int old = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+		m_back = old & INDEX;
+	}
+
+	  // Consumer only: the latest value published.  It stays valid, and
+	  // unchanged, until the next call.
+	const T& front()
+	{
+		if (m_middle.load(std::memory_order_relaxed) & FRESH)
+		{
+			int old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+			m_front = old & INDEX;
+		}
+		return m_slots[m_front];
+	}
+
+  private:
+	static const int INDEX = 3;
+	static const int FRESH = 4;	 // set while the middle slot hasn't been taken
+
+	T				 m_slots[3];
+	int				 m_back;	// used by the producer only
+	std::atomic<int> m_middle;
+	int				 m_front;	// used by the consumer only
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+};
+
+#endif // TRIPLEBUFFER_H_
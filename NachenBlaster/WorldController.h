@@ -0,0 +1,24 @@
+#ifndef WORLDCONTROLLER_H_
+#define WORLDCONTROLLER_H_
+
+#include <string>
+
+const int INVALID_KEY = 0;
+
+  // The services a GameWorld needs from whatever is driving it.  The GLUT
+  // GameController is one implementation; HeadlessController is another.
+
+class WorldController
+{
+  public:
+	virtual ~WorldController()
+	{
+	}
+
+	virtual bool getLastKey(int& value) = 0;
+	virtual void playSound(int soundID) = 0;
+	virtual void setGameStatText(const std::string& text) = 0;
+	virtual void quitGame() = 0;
+};
+
+#endif // WORLDCONTROLLER_H_
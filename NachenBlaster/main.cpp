@@ -1,21 +1,319 @@
 #include "GameController.h"
+#include "HeadlessController.h"
+#include "GameWorld.h"
+#include "ActorPool.h"
+#include "Replay.h"
+#include "BatchRunner.h"
+#include "Profiler.h"
+#include "Benchmark.h"
+#include "SoundFX.h"
+#include "FrameCapture.h"
+#include "AssetPack.h"
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <memory>
 using namespace std;
 
   // If your program is having trouble finding the Assets directory,
   // replace the string literal with a full path name to the directory,
   // e.g., "Z:/CS32/NachenBlaster/Assets" or "/Users/fred/cs32/NachenBlaster/Assets"
 
-const string assetDirectory = "Assets"; 
+const string assetDirectory = "Assets";
 
 class GameWorld;
 
 GameWorld* createStudentWorld(string assetDir = "");
 
+  // Apply "-seed N", if given, so the world's randomness is reproducible
+
+static void applySeed(int argc, char* argv[], GameWorld* gw)
+{
+	for (int k = 1; k+1 < argc; k++)
+	{
+		if (strcmp(argv[k], "-seed") == 0)
+			gw->setSeed(strtoull(argv[k+1], nullptr, 10));
+	}
+}
+
+  // With "-trace file", print the tick profile and write it as a Chrome trace
+
+static void reportProfile(int argc, char* argv[])
+{
+	for (int k = 1; k+1 < argc; k++)
+	{
+		if (strcmp(argv[k], "-trace") == 0)
+		{
+#ifdef NB_ENABLE_PROFILING
+			Profiler::printSummaries(cout);
+			if (!Profiler::writeChromeTrace(argv[k+1]))
+				cout << "Cannot write trace file " << argv[k+1] << endl;
+#else
+			cout << "Profiling is not compiled in; build with NB_ENABLE_PROFILING" << endl;
+#endif
+		}
+	}
+}
+
+  // Run the game without a window:
+  //   NachenBlaster -headless [-ticks N] [-keys scriptFile] [-seed N] [-record replayFile]
+  //   NachenBlaster -headless -replay replayFile
+  // Either form also accepts [-trace traceFile], and renders the playfield
+  // offscreen with [-frames outDir] to write every Nth frame (with
+  // [-every N]) and/or [-golden goldenDir] to compare each frame with the
+  // one written earlier, allowing [-tolerance N] in each channel.
+
+static int runHeadless(int argc, char* argv[])
+{
+	unsigned long maxTicks = 100000;
+	string script = DEFAULT_KEY_SCRIPT;
+	string recordFilename;
+	string replayFilename;
+	string framesDir;
+	string goldenDir;
+	unsigned int every = 1;
+	int tolerance = 0;
+
+	for (int k = 1; k < argc; k++)
+	{
+		if (strcmp(argv[k], "-ticks") == 0  &&  k+1 < argc)
+			maxTicks = strtoul(argv[++k], nullptr, 10);
+		else if (strcmp(argv[k], "-frames") == 0  &&  k+1 < argc)
+			framesDir = argv[++k];
+		else if (strcmp(argv[k], "-golden") == 0  &&  k+1 < argc)
+			goldenDir = argv[++k];
+		else if (strcmp(argv[k], "-every") == 0  &&  k+1 < argc)
+			every = static_cast<unsigned int>(strtoul(argv[++k], nullptr, 10));
+		else if (strcmp(argv[k], "-tolerance") == 0  &&  k+1 < argc)
+			tolerance = atoi(argv[++k]);
+		else if (strcmp(argv[k], "-keys") == 0  &&  k+1 < argc)
+		{
+			if (!ScriptedKeySource::loadFromFile(argv[++k], script))
+			{
+				cout << "Cannot read key script " << argv[k] << endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[k], "-record") == 0  &&  k+1 < argc)
+			recordFilename = argv[++k];
+		else if (strcmp(argv[k], "-replay") == 0  &&  k+1 < argc)
+			replayFilename = argv[++k];
+	}
+
+	GameWorld* gw = createStudentWorld(assetDirectory);
+	applySeed(argc, argv, gw);
+
+	Replay replay;
+	if (!replayFilename.empty())
+	{
+		if (!replay.load(replayFilename))
+		{
+			cout << "Cannot read replay file " << replayFilename << endl;
+			delete gw;
+			return 1;
+		}
+		gw->setSeed(replay.getSeed());
+		maxTicks = replay.getNumTicks();
+	}
+
+	ScriptedKeySource scriptedKeys(script);
+	ReplayPlayer player(replay);
+	KeySource& keys = (replayFilename.empty() ? static_cast<KeySource&>(scriptedKeys) : player);
+	HeadlessController controller(keys);
+	ReplayRecorder recorder;
+	TickListener* listener = nullptr;
+	if (!replayFilename.empty())
+		listener = &player;
+	else if (!recordFilename.empty())
+	{
+		if (!recorder.start(recordFilename, &controller, gw->getSeed()))
+		{
+			cout << "Cannot write replay file " << recordFilename << endl;
+			delete gw;
+			return 1;
+		}
+		controller.interpose(&recorder);
+		listener = &recorder;
+	}
+
+	unique_ptr<SoftwareRenderer> renderer;
+	unique_ptr<FrameCapture> capture;
+	if (!framesDir.empty()  ||  !goldenDir.empty())
+	{
+		renderer.reset(new SoftwareRenderer);
+		if (!loadGameSprites(*renderer, assetDirectory))
+		{
+			cout << "Cannot load the sprites in " << assetDirectory << endl;
+			delete gw;
+			return 1;
+		}
+		capture.reset(new FrameCapture(*renderer, every, framesDir, goldenDir, tolerance));
+		capture->chain(listener);
+		listener = capture.get();
+	}
+	controller.setTickListener(listener);
+
+	unsigned long long seed = gw->getSeed();
+	HeadlessResult result = controller.run(gw, maxTicks);
+	recorder.finish();
+	PoolStats pools = gw->getActorPools().getTotalStats();
+	delete gw;
+
+	cout << "Seed: " << seed << "  Ticks: " << result.ticks << "  Score: " << result.score
+		 << "  Level: " << result.level << "  Seconds: " << result.seconds;
+	if (result.seconds > 0)
+		cout << "  Ticks/s: " << static_cast<unsigned long>(result.ticks / result.seconds);
+	cout << endl;
+	for (int k = 0; k < NUM_GAME_EVENT_TYPES; k++)
+		cout << (k == 0 ? "" : "  ") << gameEventName(k) << ": " << result.events.counts[k];
+	cout << endl;
+
+	cout << "Pooled actors: " << pools.allocations << "  Pool chunks: " << pools.chunks << endl;
+	reportProfile(argc, argv);
+
+	if (capture)
+	{
+		const vector<FrameCapture::Mismatch>& mismatches = capture->getMismatches();
+		const size_t MAX_REPORTED = 10;
+		for (size_t k = 0; k < mismatches.size()  &&  k < MAX_REPORTED; k++)
+		{
+			if (mismatches[k].pixels == 0)
+				cout << "No golden frame for tick " << mismatches[k].tick << endl;
+			else
+				cout << "Frame at tick " << mismatches[k].tick << " differs in "
+					 << mismatches[k].pixels << " pixels" << endl;
+		}
+		cout << "Frames: " << capture->getNumFrames();
+		if (!goldenDir.empty())
+			cout << "  Mismatched: " << mismatches.size();
+		cout << endl;
+		if (!capture->getWriteFailure().empty())
+		{
+			cout << "Cannot write frame " << capture->getWriteFailure() << endl;
+			return 1;
+		}
+		if (!mismatches.empty())
+			return 1;
+	}
+
+	if (!replayFilename.empty())
+	{
+		if (player.hasDiverged())
+		{
+			cout << "Replay diverged at tick " << player.getDivergentTick() << endl;
+			return 1;
+		}
+		cout << "Replay matched " << player.getNumVerified() << " checksums" << endl;
+	}
+	return 0;
+}
+
+  // Play many headless games at once, one seed each:
+  //   NachenBlaster -batch numGames [-threads N] [-seed firstSeed] [-ticks N] [-keys scriptFile]
+
+static int runBatch(int argc, char* argv[])
+{
+	unsigned int numGames = 0;
+	unsigned int numThreads = thread::hardware_concurrency();
+	unsigned long long firstSeed = 1;
+	unsigned long maxTicks = 100000;
+	string script = DEFAULT_KEY_SCRIPT;
+
+	for (int k = 1; k < argc; k++)
+	{
+		if (strcmp(argv[k], "-batch") == 0  &&  k+1 < argc)
+			numGames = static_cast<unsigned int>(strtoul(argv[++k], nullptr, 10));
+		else if (strcmp(argv[k], "-threads") == 0  &&  k+1 < argc)
+			numThreads = static_cast<unsigned int>(strtoul(argv[++k], nullptr, 10));
+		else if (strcmp(argv[k], "-seed") == 0  &&  k+1 < argc)
+			firstSeed = strtoull(argv[++k], nullptr, 10);
+		else if (strcmp(argv[k], "-ticks") == 0  &&  k+1 < argc)
+			maxTicks = strtoul(argv[++k], nullptr, 10);
+		else if (strcmp(argv[k], "-keys") == 0  &&  k+1 < argc)
+		{
+			if (!ScriptedKeySource::loadFromFile(argv[++k], script))
+			{
+				cout << "Cannot read key script " << argv[k] << endl;
+				return 1;
+			}
+		}
+	}
+
+	auto start = chrono::steady_clock::now();
+	BatchRunner runner(createStudentWorld, assetDirectory, numThreads);
+	vector<BatchGameResult> results = runner.run(numGames, firstSeed, maxTicks, script);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	unsigned long long totalTicks = 0;
+	for (size_t k = 0; k < results.size(); k++)
+	{
+		const HeadlessResult& r = results[k].result;
+		cout << "Game " << k << "  Seed: " << results[k].seed << "  Score: " << r.score
+			 << "  Level: " << r.level << "  Ticks: " << r.ticks << "  Seconds: " << r.seconds << endl;
+		totalTicks += r.ticks;
+	}
+	cout << "Games: " << results.size() << "  Threads: " << (numThreads == 0 ? 1 : numThreads)
+		 << "  Ticks: " << totalTicks << "  Seconds: " << seconds;
+	if (seconds > 0)
+		cout << "  Games/s: " << results.size() / seconds;
+	cout << endl;
+	return 0;
+}
+
+  // Pack the sprites' TGA files, with their mip levels, into the asset
+  // pack the game then loads instead of them:
+  //   NachenBlaster -pack [packFile]
+  // The pack goes in the Assets directory unless packFile is given.
+
+static int buildAssetPack(int argc, char* argv[])
+{
+	string packFilename = assetDirectory;
+	if (!packFilename.empty())
+		packFilename += '/';
+	packFilename += ASSET_PACK_FILENAME;
+	for (int k = 1; k+1 < argc; k++)
+	{
+		if (strcmp(argv[k], "-pack") == 0)
+			packFilename = argv[k+1];
+	}
+
+	SpriteAtlas atlas;
+	if (!buildGameSpriteAtlas(assetDirectory, atlas))
+	{
+		cout << "Cannot load and pack the sprites in " << assetDirectory << endl;
+		return 1;
+	}
+	vector<AssetPack::SourceStamp> stamps;
+	if (!stampGameSpriteSources(assetDirectory, stamps)  ||
+		!AssetPack::write(packFilename, atlas, stamps))
+	{
+		cout << "Cannot write asset pack " << packFilename << endl;
+		return 1;
+	}
+	const RgbaImage& full = atlas.getLevels()[0];
+	cout << "Sprites: " << atlas.getSprites().size() << "  Atlas: " << full.width << "x" << full.height
+		 << "  Levels: " << atlas.getLevels().size() << "  Wrote " << packFilename << endl;
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
+	for (int k = 1; k < argc; k++)
+	{
+		if (strcmp(argv[k], "-headless") == 0)
+			return runHeadless(argc, argv);
+		if (strcmp(argv[k], "-batch") == 0)
+			return runBatch(argc, argv);
+		if (strcmp(argv[k], "-bench") == 0)
+			return runBenchmarks(argc, argv);
+		if (strcmp(argv[k], "-pack") == 0)
+			return buildAssetPack(argc, argv);
+	}
+
 	{
 		string path = assetDirectory;
 		if (!path.empty())
@@ -30,6 +328,41 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	GameWorld* gw = createStudentWorld(assetDirectory);
-	Game().run(argc, argv, gw, "NachenBlaster");
+	bool threaded = false;
+	for (int k = 1; k < argc; k++)
+	{
+		if (strcmp(argv[k], "-threaded") == 0)
+			threaded = true;
+		else if (strcmp(argv[k], "-software") == 0)
+			Game().useSoftwareRenderer(true);
+		else if (strcmp(argv[k], "-stats") == 0)
+			Game().showStats(true);
+		else if (strcmp(argv[k], "-interpolate") == 0)
+			Game().setInterpolation(true);
+		else if (k+1 == argc)
+			break;
+		else if (strcmp(argv[k], "-record") == 0)
+			Game().recordTo(argv[k+1]);
+		else if (strcmp(argv[k], "-tickrate") == 0)
+			Game().setTickRate(atof(argv[k+1]));
+		else if (strcmp(argv[k], "-fps") == 0)
+			Game().setFrameRate(atof(argv[k+1]));
+#ifdef SOUNDFX_HAS_MIXER
+		else if (strcmp(argv[k], "-audio") == 0)
+			SoundFX().setOutput(argv[k+1]);
+#endif
+	}
+	if (threaded)
+	{
+		  // the world must be made and seeded on the simulation thread
+		Game().runThreaded(argc, argv, createStudentWorld, assetDirectory, "NachenBlaster",
+						   [argc, argv](GameWorld& gw) { applySeed(argc, argv, &gw); });
+	}
+	else
+	{
+		GameWorld* gw = createStudentWorld(assetDirectory);
+		applySeed(argc, argv, gw);
+		Game().run(argc, argv, gw, "NachenBlaster");
+	}
+	reportProfile(argc, argv);
 }